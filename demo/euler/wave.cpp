@@ -0,0 +1,329 @@
+// Copyright 2021 Minghao Yang
+
+#include <omp.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/mesh/data.hpp"
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/riemann/ausm.hpp"
+#include "buaa/riemann/hllc.hpp"
+#include "buaa/riemann/roe.hpp"
+#include "buaa/solver/rkvr.hpp"
+#include "buaa/data/path.hpp"  // defines TEST_DATA_DIR
+
+namespace buaa {
+namespace solver {
+
+// A density wave carried by a uniform flow through a periodic tube, whose
+// exact solution is the initial one shifted by the flow.
+class DensityWaveTest : public ::testing::Test {
+ protected:
+  static constexpr int degree = 3;
+  static constexpr int num_coefficients = (degree+1) * (degree+2) / 2 - 1;
+  // Types:
+  using Gas = riemann::IdealGas;
+  using State = riemann::Conservative<2>;
+  using Primitive = riemann::Primitive<2>;
+  using Flux = riemann::Flux<2>;
+  using Stages = std::array<State, 3>;
+  using Coefficients = Eigen::Matrix<Scalar, num_coefficients, 4>;
+  struct EdgeData : public mesh::Empty {
+    Flux flux;
+  };
+  struct CellData : public mesh::Data<
+      2/* dims */, 2/* scalars */, 1/* vectors */> {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Coefficients coefficients;
+    Stages u_stages;
+    void Write() {
+      auto primitive = Gas::ConservativeToPrimitive(u_stages[0]);
+      scalars[0] = primitive.rho();
+      scalars[1] = primitive.p();
+      vectors[0] = {primitive.u(), primitive.v()};
+    }
+    void Initialize() {
+      coefficients = Coefficients::Zero();
+    }
+  };
+  using Mesh = mesh::Mesh<degree, EdgeData, CellData>;
+  using Cell = typename Mesh::Cell;
+  using Edge = typename Mesh::Edge;
+  // Data:
+  const std::string test_data_dir_{TEST_DATA_DIR};
+  const std::string mesh_name_{"tube1.vtk"};
+  const Scalar duration_{0.5};
+  const int n_steps_{40};
+  std::vector<Scalar> step_sizes_;
+  // The exact solution at `point` and `t`:
+  template <class Point>
+  static State GetExact(Point const& point, Scalar t) {
+    auto rho = 1 + 0.2 * std::sin((point.X() - t) * std::acos(-1.0));
+    return Gas::PrimitiveToConservative(Primitive(rho, 1.0, 0.0, 1.0));
+  }
+  static State GetExactMean(Cell const& cell, Scalar t) {
+    auto value = State(0);
+    cell.Integrate([&](auto const& point) {
+      return GetExact(point, t);
+    }, &value);
+    return value / cell.Measure();
+  }
+  // Read the periodic tube into `model`:
+  template <class Model>
+  void ReadTube(Model* model) const {
+    model->ReadMesh(test_data_dir_ + mesh_name_);
+    constexpr auto eps = 1e-5;
+    model->SetBoundaryName("left", [&](Edge& edge) {
+      return std::abs(edge.Center().X() + 1.0) < eps;
+    });
+    model->SetBoundaryName("right", [&](Edge& edge) {
+      return std::abs(edge.Center().X() - 1.0) < eps;
+    });
+    model->SetBoundaryName("top", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() - 0.05) < eps;
+    });
+    model->SetBoundaryName("bottom", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() + 0.05) < eps;
+    });
+    model->SetPeriodicBoundary("top", "bottom");
+    model->SetPeriodicBoundary("left", "right");
+  }
+  // L1 error of the density at the end, run by `Riemann` with the options
+  // and the time steps set by `configure`:
+  template <class Riemann, class Configure>
+  Scalar GetError(std::string const& model_name, Configure&& configure) {
+    Mesh::Cell::scalar_names.at(0) = "Density";
+    Mesh::Cell::scalar_names.at(1) = "Pressure";
+    Mesh::Cell::vector_names.at(0) = "Velocity";
+    auto model = Rkvr<Mesh, Riemann>(model_name);
+    ReadTube(&model);
+    // Set Initial Conditions, and keep the exact means at the end:
+    auto exact_means = std::vector<State>();
+    model.GetMeans(&exact_means);
+    auto measures = std::vector<Scalar>(exact_means.size());
+    model.SetInitialState([&](Cell& cell) {
+      cell.data.u_stages[0] = GetExactMean(cell, 0);
+      exact_means[cell.I()] = GetExactMean(cell, duration_);
+      measures[cell.I()] = cell.Measure();
+    });
+    configure(model);
+    auto output_dir = std::string("result/demo/") + model_name;
+    model.SetOutputDir(output_dir + "/");
+    system(("rm -rf " + output_dir).c_str());
+    system(("mkdir -p " + output_dir).c_str());
+    model.Calculate();
+    step_sizes_ = model.GetStepSizes();
+    auto means = std::vector<State>();
+    model.GetMeans(&means);
+    Scalar error = 0, area = 0;
+    for (int i = 0; i < means.size(); ++i) {
+      auto rho = means[i].mass(), rho_exact = exact_means[i].mass();
+      error += std::abs(rho - rho_exact) * measures[i];
+      area += measures[i];
+    }
+    return error / area;
+  }
+  // Same, with the fixed steps and the default options:
+  template <class Riemann>
+  Scalar GetError(std::string const& model_name) {
+    return GetError<Riemann>(model_name, [&](auto& model) {
+      SetTimeSteps(&model);
+    });
+  }
+  template <class Model>
+  void SetTimeSteps(Model* model) const {
+    model->SetTimeSteps(duration_, n_steps_, n_steps_);
+  }
+  template <class Riemann>
+  void CheckError(std::string const& model_name) {
+    auto error = GetError<Riemann>(model_name);
+    EXPECT_LT(error, 1e-4);
+    EXPECT_NEAR(GetError<Riemann>(model_name, [&](auto& model) {
+      SetTimeSteps(&model);
+      model.SetFluxBatching(true);
+    }), error, 1e-5);
+  }
+};
+TEST_F(DensityWaveTest, Ausm) {
+  CheckError<riemann::Ausm<Gas, 2>>("euler_ausm");
+}
+TEST_F(DensityWaveTest, Hllc) {
+  CheckError<riemann::Hllc<Gas, 2>>("euler_hllc");
+}
+TEST_F(DensityWaveTest, Roe) {
+  CheckError<riemann::Roe<Gas, 2>>("euler_roe");
+}
+// Only `SetAdaptiveTimeSteps` is called, so that nothing is left of the
+// fixed steps:
+TEST_F(DensityWaveTest, AdaptiveTimeSteps) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto error = GetError<Riemann>("euler_adaptive", [&](auto& model) {
+    model.SetAdaptiveTimeSteps(duration_, 2.0, duration_ / 2);
+  });
+  EXPECT_LT(error, 1e-4);
+  EXPECT_NEAR(error, GetError<Riemann>("euler_fixed"), 1e-5);
+}
+// Steps that never reach the next frame are rejected:
+TEST_F(DensityWaveTest, AdaptiveTimeStepsRejected) {
+  auto model = Rkvr<Mesh, riemann::Ausm<Gas, 2>>("euler_rejected");
+  EXPECT_THROW(model.SetAdaptiveTimeSteps(duration_, 0.0, duration_ / 2),
+               std::invalid_argument);
+  EXPECT_THROW(model.SetAdaptiveTimeSteps(duration_, 2.0, 0.0),
+               std::invalid_argument);
+  EXPECT_THROW(model.SetAdaptiveTimeSteps(duration_, 2.0, -duration_),
+               std::invalid_argument);
+}
+// The two-register schemes take the fixed steps as the default one does,
+// and those of third order or higher are as accurate:
+TEST_F(DensityWaveTest, LowStorageSchemes) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto error = GetError<Riemann>("euler_fixed");
+  auto get_error = [&](std::string const& model_name, auto set_scheme) {
+    return GetError<Riemann>(model_name, [&](auto& model) {
+      SetTimeSteps(&model);
+      set_scheme(model);
+    });
+  };
+  EXPECT_LT(get_error("euler_ssp2", [](auto& model) {
+    model.template SetLowStorageScheme<Ssp2<5>>();
+  }), 1e-4);
+  EXPECT_NEAR(get_error("euler_ssp3", [](auto& model) {
+    model.template SetLowStorageScheme<Ssp3<2>>();
+  }), error, 1e-5);
+  EXPECT_NEAR(get_error("euler_ssp104", [](auto& model) {
+    model.template SetLowStorageScheme<Ssp104>();
+  }), error, 1e-5);
+  EXPECT_NEAR(get_error("euler_williamson3", [](auto& model) {
+    model.template SetLowStorageScheme<Williamson3>();
+  }), error, 1e-5);
+}
+// Steps set by a CFL number grow with the SSP coefficient of the scheme:
+TEST_F(DensityWaveTest, LowStorageAdaptiveTimeSteps) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto adaptive = [&](auto& model) {
+    model.SetAdaptiveTimeSteps(duration_, 2.0, duration_ / 2);
+  };
+  GetError<Riemann>("euler_adaptive", adaptive);
+  auto n_steps = step_sizes_.size();
+  auto error = GetError<Riemann>("euler_ssp104_adaptive", [&](auto& model) {
+    adaptive(model);
+    model.template SetLowStorageScheme<Ssp104>();
+  });
+  EXPECT_LT(error, 1e-4);
+  EXPECT_LT(step_sizes_.size() * Ssp104::Cfl(), n_steps * 1.5);
+}
+// The options of the VR sweeps change the cost, not the solution:
+TEST_F(DensityWaveTest, VrPrediction) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto error = GetError<Riemann>("euler_vr");
+  auto sweeps = [&](int n_sweeps, bool predict) {
+    return [=](auto& model) {
+      SetTimeSteps(&model);
+      model.SetVrIteration(n_sweeps, predict);
+    };
+  };
+  EXPECT_NEAR(GetError<Riemann>("euler_vr_predict", sweeps(9, true)), error,
+              1e-5);
+  // With fewer sweeps, the predicted start is closer to the solution:
+  EXPECT_LT(GetError<Riemann>("euler_vr_predict", sweeps(3, true)),
+            GetError<Riemann>("euler_vr_sweep", sweeps(3, false)));
+}
+// After a small change of the means, a few sweeps from the predicted
+// coefficients match the ones converged by many plain sweeps, and at each
+// count they are closer to them than plain sweeps from the old ones. The
+// prediction leaves out the change of the neighbors, so it saves less than
+// one sweep.
+TEST_F(DensityWaveTest, VrPredictedCoefficients) {
+  using Model = Rkvr<Mesh, riemann::Ausm<Gas, 2>>;
+  // On one thread, as a team would sweep the cells in a varying order:
+  auto reconstruct = [&](int n_sweeps, bool predict) {
+    int n_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    auto model = std::make_unique<Model>("euler_vr_coefficients");
+    ReadTube(model.get());
+    model->SetInitialState([&](Cell& cell) {
+      cell.data.u_stages[0] = GetExactMean(cell, 0);
+    });
+    model->Prepare();
+    model->SetVrIteration(50, false);
+    model->UpdateCoefficients(0);
+    model->SetInitialState([&](Cell& cell) {
+      cell.data.u_stages[0] = GetExactMean(cell, 0.02);
+    });
+    model->SetVrIteration(n_sweeps, predict);
+    model->UpdateCoefficients(0);
+    auto coefficients = std::vector<Coefficients>();
+    model->mesh_->ForEachCell([&](Cell& cell) {
+      coefficients.emplace_back(cell.data.coefficients);
+    });
+    omp_set_num_threads(n_threads);
+    return coefficients;
+  };
+  auto converged = reconstruct(50, false);
+  auto get_difference = [&](std::vector<Coefficients> const& coefficients) {
+    Scalar difference = 0;
+    for (int i = 0; i < converged.size(); ++i) {
+      difference = std::max(difference,
+          (coefficients[i] - converged[i]).cwiseAbs().maxCoeff());
+    }
+    return difference;
+  };
+  Scalar scale = 0;
+  for (auto const& coefficients : converged) {
+    scale = std::max(scale, coefficients.cwiseAbs().maxCoeff());
+  }
+  EXPECT_LT(get_difference(reconstruct(9, true)), scale * 2e-4);
+  for (int n_sweeps : {0, 3, 6}) {
+    EXPECT_LT(get_difference(reconstruct(n_sweeps, true)),
+              get_difference(reconstruct(n_sweeps, false)) * 0.9);
+  }
+}
+TEST_F(DensityWaveTest, VrTiling) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto error = GetError<Riemann>("euler_vr");
+  EXPECT_NEAR(GetError<Riemann>("euler_vr_tiling", [&](auto& model) {
+    SetTimeSteps(&model);
+    model.SetVrTiling(16);
+  }), error, 1e-5);
+}
+TEST_F(DensityWaveTest, VrCache) {
+  using Riemann = riemann::Ausm<Gas, 2>;
+  auto error = GetError<Riemann>("euler_vr");
+  auto cache = std::string("result/demo/euler_vr.cache");
+  system(("rm -f " + cache).c_str());
+  auto cached = [&](auto& model) {
+    SetTimeSteps(&model);
+    model.SetVrCache(cache);
+  };
+  auto get_inode = [&]() {
+    struct stat info;
+    return stat(cache.c_str(), &info) == 0 ? info.st_ino : 0;
+  };
+  // The first run saves the operators, and the second one loads them
+  // instead of saving another file:
+  auto saved = GetError<Riemann>("euler_vr_save", cached);
+  auto inode = get_inode();
+  EXPECT_NE(inode, 0);
+  EXPECT_NEAR(saved, error, 1e-5);
+  EXPECT_EQ(GetError<Riemann>("euler_vr_load", cached), saved);
+  EXPECT_EQ(get_inode(), inode);
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,127 @@
+// Copyright 2021 Minghao Yang
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/riemann/ausm.hpp"
+#include "buaa/riemann/hllc.hpp"
+#include "buaa/riemann/roe.hpp"
+
+namespace buaa {
+namespace riemann {
+
+class FluxBenchmark : public ::testing::Test {
+ protected:
+  using Gas = IdealGas;
+  using State = Primitive<2>;
+  static constexpr int kPoints = 1 << 16;
+  static constexpr int kRepeats = 64;
+  // Random states of subsonic and supersonic flows on random normals:
+  void SetUp() override {
+    auto engine = std::mt19937(2021);
+    auto uniform = std::uniform_real_distribution<Scalar>(-1, 1);
+    for (auto* u : {&left_, &right_}) {
+      for (auto& column : *u) { column.resize(kPoints); }
+      for (int i = 0; i < kPoints; ++i) {
+        auto state = State{1.5f + uniform(engine), 2 * uniform(engine),
+                           2 * uniform(engine), 1.5f + uniform(engine)};
+        auto conservative = Gas::PrimitiveToConservative(state);
+        (*u)[0][i] = conservative.mass();
+        (*u)[1][i] = conservative.momentum(0);
+        (*u)[2][i] = conservative.momentum(1);
+        (*u)[3][i] = conservative.energy();
+      }
+    }
+    for (auto& column : normals_) { column.resize(kPoints); }
+    for (int i = 0; i < kPoints; ++i) {
+      Scalar angle = std::acos(Scalar(-1)) * uniform(engine);
+      normals_[0][i] = std::cos(angle);
+      normals_[1][i] = std::sin(angle);
+    }
+    for (auto& column : fluxes_) { column.resize(kPoints); }
+  }
+  // Nanoseconds per point of `Solver::GetFluxes`:
+  template <class Solver>
+  double Time() {
+    auto get = [](auto& u) {
+      return ConstArrays<4>{u[0].data(), u[1].data(), u[2].data(),
+                            u[3].data()};
+    };
+    auto fluxes = Arrays<4>{fluxes_[0].data(), fluxes_[1].data(),
+                            fluxes_[2].data(), fluxes_[3].data()};
+    auto normals = ConstArrays<2>{normals_[0].data(), normals_[1].data()};
+    auto begin = std::chrono::steady_clock::now();
+    for (int k = 0; k < kRepeats; ++k) {
+      Solver::GetFluxes(kPoints, get(left_), get(right_), normals, fluxes);
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (auto& column : fluxes_) {
+      for (auto f : column) { EXPECT_TRUE(std::isfinite(f)); }
+    }
+    return std::chrono::duration<double, std::nano>(end - begin).count() /
+           (kPoints * kRepeats);
+  }
+  // L1 error of the density of a contact of speed `u`, after `n_steps` of
+  // first-order finite volumes by `Solver` on `n_cells` cells of [0, 1]:
+  template <class Solver>
+  static double GetContactError(Scalar u, int n_cells, int n_steps) {
+    // At pressure 1, the sound is fastest in the lighter gas:
+    Scalar a = std::sqrt(Gas::Gamma() / 0.125f);
+    Scalar dx = 1.0 / n_cells, dt = 0.4 * dx / (std::abs(u) + a);
+    auto density = [&](Scalar x) { return x < 0.5 ? 1.0 : 0.125; };
+    auto cells = std::vector<Conservative<2>>(n_cells);
+    for (int i = 0; i < n_cells; ++i) {
+      cells[i] = Gas::PrimitiveToConservative(
+          State{Scalar(density((i + 0.5) * dx)), u, 0, 1});
+    }
+    auto fluxes = std::vector<Flux<2>>(n_cells + 1);
+    for (int step = 0; step < n_steps; ++step) {
+      for (int i = 0; i <= n_cells; ++i) {
+        auto left = Gas::ConservativeToPrimitive(cells[std::max(i - 1, 0)]);
+        auto right = Gas::ConservativeToPrimitive(
+            cells[std::min(i, n_cells - 1)]);
+        fluxes[i] = Solver::GetFlux(left, right);
+      }
+      for (int i = 0; i < n_cells; ++i) {
+        auto change = fluxes[i];
+        change -= fluxes[i + 1];
+        change *= dt / dx;
+        cells[i] += change;
+      }
+    }
+    double error = 0;
+    for (int i = 0; i < n_cells; ++i) {
+      error += std::abs(cells[i].mass() -
+                        density((i + 0.5) * dx - u * dt * n_steps)) * dx;
+    }
+    return error;
+  }
+  std::vector<Scalar> left_[4], right_[4], normals_[2], fluxes_[4];
+};
+TEST_F(FluxBenchmark, TestThroughput) {
+  std::printf("GetFluxes of AUSM: %.2f ns per point\n",
+              Time<Ausm<Gas, 2>>());
+  std::printf("GetFluxes of HLLC: %.2f ns per point\n",
+              Time<Hllc<Gas, 2>>());
+  std::printf("GetFluxes of Roe:  %.2f ns per point\n",
+              Time<Roe<Gas, 2>>());
+}
+TEST_F(FluxBenchmark, TestDissipation) {
+  for (Scalar u : {0.0, 0.5}) {
+    auto ausm = GetContactError<Ausm<Gas, 2>>(u, 200, 200);
+    auto hllc = GetContactError<Hllc<Gas, 2>>(u, 200, 200);
+    auto roe = GetContactError<Roe<Gas, 2>>(u, 200, 200);
+    std::printf("L1 error of a contact of speed %.1f: "
+                "AUSM %.3e, HLLC %.3e, Roe %.3e\n", u, ausm, hllc, roe);
+    EXPECT_LE(hllc, ausm);
+    EXPECT_LE(roe, ausm);
+  }
+}
+
+}  // namespace riemann
+}  // namespace buaa
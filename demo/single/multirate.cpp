@@ -0,0 +1,160 @@
+// Copyright 2021 Minghao Yang
+
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/mesh/data.hpp"
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/riemann/linear.hpp"
+#include "buaa/solver/rkvr.hpp"
+#include "buaa/data/path.hpp"  // defines TEST_DATA_DIR
+
+namespace buaa {
+namespace solver {
+
+// A sine wave carried through a periodic tube, whose cells shrink towards
+// its middle, so that the steps they allow differ by a factor of seven.
+class MultirateTest : public ::testing::Test {
+ protected:
+  static constexpr int degree = 3;
+  static constexpr int num_coefficients = (degree+1) * (degree+2) / 2 - 1;
+  // Types:
+  using Stages = Eigen::Matrix<Scalar, 3, 1>;
+  using Coefficients = Eigen::Matrix<Scalar, num_coefficients, 1>;
+  using Riemann = buaa::riemann::Linear;
+  using Flux = typename Riemann::Flux;
+  struct EdgeData : public mesh::Empty {
+    Flux flux;
+  };
+  struct CellData : public mesh::Data<
+      2/* dims */, 1/* scalars */, 0/* vectors */> {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Coefficients coefficients;
+    Stages u_stages;
+    void Write() {
+      scalars[0] = u_stages[0];
+    }
+    void Initialize() {
+      coefficients = Coefficients::Zero();
+    }
+  };
+  using Mesh = mesh::Mesh<degree, EdgeData, CellData>;
+  using Cell = typename Mesh::Cell;
+  using Edge = typename Mesh::Edge;
+  using Model = Rkvr<Mesh, Riemann>;
+  // Data:
+  const std::string test_data_dir_{TEST_DATA_DIR};
+  const std::string mesh_name_{"graded.vtk"};
+  const Scalar duration_{0.5};
+  // Of the last run: the L1 error, the integrals of u at the end and at the
+  // start, the number of levels used, and the steps residuals were taken at:
+  Scalar error_{0}, total_{0}, initial_total_{0};
+  int n_levels_{0};
+  std::vector<int> residual_steps_;
+  // Run `n_steps` multirate steps on at most `n_levels` levels, monitoring
+  // the residual every `monitor_rate` steps if it is positive, and smoothing
+  // it by `epsilon` if that is:
+  void Run(std::string const& model_name, int n_steps, int n_levels,
+           int monitor_rate = 0, Scalar epsilon = 0) {
+    Mesh::Cell::scalar_names.at(0) = "U";
+    auto model = Model(model_name);
+    model.ReadMesh(test_data_dir_ + mesh_name_);
+    // Set Boundary Conditions:
+    constexpr auto eps = 1e-5;
+    model.SetBoundaryName("left", [&](Edge& edge) {
+      return std::abs(edge.Center().X() + 1.0) < eps;
+    });
+    model.SetBoundaryName("right", [&](Edge& edge) {
+      return std::abs(edge.Center().X() - 1.0) < eps;
+    });
+    model.SetBoundaryName("top", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() - 0.05) < eps;
+    });
+    model.SetBoundaryName("bottom", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() + 0.05) < eps;
+    });
+    model.SetPeriodicBoundary("top", "bottom");
+    model.SetPeriodicBoundary("left", "right");
+    // Set Initial Conditions:
+    auto exact = [&](Cell const& cell, Scalar t) {
+      Scalar value = 0;
+      cell.Integrate([&](auto const& point) {
+        return std::sin((point.X() - t) * std::acos(0.0) * 4);
+      }, &value);
+      return value;
+    };
+    model.SetInitialState([&](Cell& cell) {
+      cell.data.u_stages[0] = exact(cell, 0) / cell.Measure();
+    });
+    initial_total_ = 0;
+    model.mesh_->ForEachCell([&](Cell& cell) {
+      initial_total_ += cell.data.u_stages[0] * cell.Measure();
+    });
+    model.SetMultirateTimeSteps(duration_, n_steps, n_steps, 1.0, n_levels);
+    model.SetResidualMonitor(monitor_rate, 0);
+    model.SetResidualSmoothing(epsilon);
+    auto output_dir = std::string("result/demo/") + model_name;
+    model.SetOutputDir(output_dir + "/");
+    system(("rm -rf " + output_dir).c_str());
+    system(("mkdir -p " + output_dir).c_str());
+    model.Calculate();
+    error_ = 0;
+    total_ = 0;
+    Scalar area = 0;
+    model.mesh_->ForEachCell([&](Cell& cell) {
+      auto value = cell.data.u_stages[0] * cell.Measure();
+      error_ += std::abs(value - exact(cell, duration_));
+      total_ += value;
+      area += cell.Measure();
+    });
+    error_ /= area;
+    n_levels_ = model.rates_.CountLevels();
+    residual_steps_ = model.GetResidualSteps();
+  }
+};
+// The fluxes of faces between levels are those the finer side integrated:
+TEST_F(MultirateTest, Conservation) {
+  Run("multirate_3", 112, 3);
+  EXPECT_EQ(n_levels_, 3);
+  EXPECT_NEAR(total_, initial_total_, 1e-7);
+}
+// Halving the step moves the cells to coarser levels and cuts the error:
+TEST_F(MultirateTest, Convergence) {
+  Run("multirate_3", 112, 3);
+  auto error = error_;
+  EXPECT_LT(error, 1e-4);
+  Run("multirate_2", 224, 3);
+  EXPECT_EQ(n_levels_, 2);
+  EXPECT_LT(error_, error / 2);
+}
+// The residual of u^n is taken on schedule, though no level updates all
+// the fluxes at once:
+TEST_F(MultirateTest, ResidualMonitor) {
+  Run("multirate_monitor", 112, 3, 10);
+  auto expected = std::vector<int>();
+  for (int i = 0; i < 112; i += 10) { expected.emplace_back(i); }
+  EXPECT_EQ(residual_steps_, expected);
+}
+// A cell whose step is still too large at the finest level is an error:
+TEST_F(MultirateTest, TooFewLevels) {
+  EXPECT_THROW(Run("multirate_too_few", 112, 2), std::runtime_error);
+}
+// Levels step with the fluxes of their own faces, which are not smoothed:
+TEST_F(MultirateTest, ResidualSmoothing) {
+  EXPECT_THROW(Run("multirate_smoothed", 112, 3, 0, 0.5),
+               std::invalid_argument);
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,170 @@
+// Copyright 2021 Minghao Yang
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/mesh/data.hpp"
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/riemann/linear.hpp"
+#include "buaa/solver/parareal.hpp"
+#include "buaa/solver/rkvr.hpp"
+#include "buaa/data/path.hpp"  // defines TEST_DATA_DIR
+
+namespace buaa {
+namespace solver {
+
+// A sine wave carried through a periodic tube by `Parareal`, whose coarse
+// propagator is a degree-1 `Rkvr` taking two steps per slice, and whose fine
+// one a degree-3 `Rkvr` taking four, one model per thread, each on a mesh of
+// its own.
+class PararealTest : public ::testing::Test {
+ protected:
+  using Riemann = buaa::riemann::Linear;
+  using Flux = typename Riemann::Flux;
+  struct EdgeData : public mesh::Empty {
+    Flux flux;
+  };
+  template <int kDegree>
+  struct CellData : public mesh::Data<
+      2/* dims */, 1/* scalars */, 0/* vectors */> {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    static constexpr int num_coefficients =
+        (kDegree+1) * (kDegree+2) / 2 - 1;
+    Eigen::Matrix<Scalar, num_coefficients, 1> coefficients;
+    Eigen::Matrix<Scalar, 3, 1> u_stages;
+    void Write() {
+      scalars[0] = u_stages[0];
+    }
+    void Initialize() {
+      coefficients.setZero();
+    }
+  };
+  template <int kDegree>
+  using Mesh = mesh::Mesh<kDegree, EdgeData, CellData<kDegree>>;
+  template <int kDegree>
+  using Model = Rkvr<Mesh<kDegree>, Riemann>;
+  using Value = std::vector<Scalar>;
+  // Data:
+  const std::string test_data_dir_{TEST_DATA_DIR};
+  const std::string mesh_name_{"tube1.vtk"};
+  const Scalar duration_{0.5};
+  const int n_slices_{10};
+  const int n_fine_steps_{4};
+  const int n_coarse_steps_{2};
+  // A model on a mesh of its own, holding the initial wave:
+  template <int kDegree>
+  auto Build(std::string const& model_name) const {
+    auto model = std::make_unique<Model<kDegree>>(model_name);
+    model->ReadMesh(test_data_dir_ + mesh_name_);
+    using Edge = typename Mesh<kDegree>::Edge;
+    constexpr auto eps = 1e-5;
+    model->SetBoundaryName("left", [&](Edge& edge) {
+      return std::abs(edge.Center().X() + 1.0) < eps;
+    });
+    model->SetBoundaryName("right", [&](Edge& edge) {
+      return std::abs(edge.Center().X() - 1.0) < eps;
+    });
+    model->SetBoundaryName("top", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() - 0.05) < eps;
+    });
+    model->SetBoundaryName("bottom", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() + 0.05) < eps;
+    });
+    model->SetPeriodicBoundary("top", "bottom");
+    model->SetPeriodicBoundary("left", "right");
+    model->SetInitialState([&](typename Mesh<kDegree>::Cell& cell) {
+      Scalar value = 0;
+      cell.Integrate([&](auto const& point) {
+        return std::sin(point.X() * std::acos(0.0) * 4);
+      }, &value);
+      cell.data.u_stages[0] = value / cell.Measure();
+    });
+    model->SetVrIteration(2, true);
+    return model;
+  }
+  Scalar GetSliceSize() const { return duration_ / n_slices_; }
+  // Propagate `u` over one slice by `model`, on the calling thread alone:
+  // the VR sweeps update the coefficients in place, so a team of threads
+  // would leave them depending on the order it reaches the cells in.
+  template <class Model>
+  void Propagate(Model* model, int n_steps, Value const& u, Value* v) const {
+    int n_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    model->SetMeans(u);
+    model->March(GetSliceSize() / n_steps, n_steps);
+    model->GetMeans(v);
+    omp_set_num_threads(n_threads);
+  }
+  static Scalar GetMaxDifference(Value const& u, Value const& v) {
+    Scalar difference = 0;
+    for (int i = 0; i < u.size(); ++i) {
+      difference = std::max(difference, std::abs(u[i] - v[i]));
+    }
+    return difference;
+  }
+};
+// Each propagation starts from the means alone, whatever was marched before:
+TEST_F(PararealTest, SetMeans) {
+  auto used = Build<3>("parareal_used");
+  auto fresh = Build<3>("parareal_fresh");
+  auto u = Value(), v = Value(), w = Value();
+  fresh->GetMeans(&u);
+  Propagate(used.get(), n_fine_steps_, u, &v);
+  Propagate(used.get(), n_fine_steps_, v, &w);
+  Propagate(used.get(), n_fine_steps_, u, &v);
+  Propagate(fresh.get(), n_fine_steps_, u, &w);
+  EXPECT_EQ(GetMaxDifference(v, w), 0);
+}
+// After k iterations, the first k slices are those of the fine model marched
+// through them in order, and the later ones are closer to them than the
+// coarse ones. Pure advection converges slowly, as the degree-1 wave lags.
+TEST_F(PararealTest, Iterate) {
+  auto coarse = Build<1>("parareal_coarse");
+  auto fines = std::vector<std::unique_ptr<Model<3>>>();
+  for (int i = 0; i < omp_get_max_threads(); ++i) {
+    fines.emplace_back(Build<3>("parareal_fine_" + std::to_string(i)));
+  }
+  auto u_0 = Value();
+  coarse->GetMeans(&u_0);
+  auto solve = [&](int n_iterations) {
+    auto parareal = Parareal<Scalar>();
+    parareal.Solve(u_0, n_slices_, [&](int n, auto& u, auto* v) {
+      Propagate(coarse.get(), n_coarse_steps_, u, v);
+    }, [&](int n, auto& u, auto* v) {
+      Propagate(fines[omp_get_thread_num()].get(), n_fine_steps_, u, v);
+    }, n_iterations, 0);
+    return parareal;
+  };
+  auto serial = Build<3>("parareal_serial");
+  auto values = std::vector<Value>{u_0};
+  for (int n = 1; n <= n_slices_; ++n) {
+    values.emplace_back();
+    Propagate(serial.get(), n_fine_steps_, values[n - 1], &values[n]);
+  }
+  auto u_coarse = solve(0).GetValue(n_slices_);
+  Scalar coarse_error = GetMaxDifference(u_coarse, values.back());
+  EXPECT_GT(coarse_error, 1e-2);
+  int k = 3;
+  auto parareal = solve(k);
+  for (int n = 1; n <= k; ++n) {
+    EXPECT_LT(GetMaxDifference(parareal.GetValue(n), values[n]), 1e-6);
+  }
+  EXPECT_LT(GetMaxDifference(parareal.GetValue(n_slices_), values.back()),
+            coarse_error * 0.7);
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
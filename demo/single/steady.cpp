@@ -0,0 +1,207 @@
+// Copyright 2021 Minghao Yang
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/mesh/data.hpp"
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/riemann/linear.hpp"
+#include "buaa/solver/rkvr.hpp"
+#include "buaa/data/path.hpp"  // defines TEST_DATA_DIR
+
+namespace buaa {
+namespace solver {
+
+// Steady problems on a periodic tube, for the options that march to steady
+// states. The upwind fluxes damp noise on a uniform state, so that its
+// residual falls towards zero.
+class SteadyTest : public ::testing::Test {
+ protected:
+  static constexpr int degree = 3;
+  static constexpr int num_coefficients = (degree+1) * (degree+2) / 2 - 1;
+  // Types:
+  using Stages = Eigen::Matrix<Scalar, 3, 1>;
+  using Coefficients = Eigen::Matrix<Scalar, num_coefficients, 1>;
+  using Riemann = buaa::riemann::Linear;
+  using Flux = typename Riemann::Flux;
+  struct EdgeData : public mesh::Empty {
+    Flux flux;
+  };
+  struct CellData : public mesh::Data<
+      2/* dims */, 1/* scalars */, 0/* vectors */> {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Coefficients coefficients;
+    Stages u_stages;
+    void Write() {
+      scalars[0] = u_stages[0];
+    }
+    void Initialize() {
+      coefficients = Coefficients::Zero();
+    }
+  };
+  using Mesh = mesh::Mesh<degree, EdgeData, CellData>;
+  using Cell = typename Mesh::Cell;
+  using Edge = typename Mesh::Edge;
+  using Model = Rkvr<Mesh, Riemann>;
+  // Data:
+  const std::string test_data_dir_{TEST_DATA_DIR};
+  const std::string mesh_name_{"tube2.vtk"};
+  const int n_steps_{100};
+  // Run the model set up by `configure` from the cell means given by
+  // `initial`, then pass it to `visit`:
+  template <class Initial, class Configure, class Visitor>
+  void Run(std::string const& model_name, Initial&& initial,
+           Configure&& configure, Visitor&& visit) {
+    Mesh::Cell::scalar_names.at(0) = "U";
+    auto model = Model(model_name);
+    model.ReadMesh(test_data_dir_ + mesh_name_);
+    // Set Boundary Conditions:
+    constexpr auto eps = 1e-5;
+    model.SetBoundaryName("left", [&](Edge& edge) {
+      return std::abs(edge.Center().X() + 1.0) < eps;
+    });
+    model.SetBoundaryName("right", [&](Edge& edge) {
+      return std::abs(edge.Center().X() - 1.0) < eps;
+    });
+    model.SetBoundaryName("top", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() - 0.05) < eps;
+    });
+    model.SetBoundaryName("bottom", [&](Edge& edge) {
+      return std::abs(edge.Center().Y() + 0.05) < eps;
+    });
+    model.SetPeriodicBoundary("top", "bottom");
+    model.SetPeriodicBoundary("left", "right");
+    // Set Initial Conditions:
+    model.SetInitialState([&](Cell& cell) {
+      cell.data.u_stages[0] = initial(cell);
+    });
+    configure(model);
+    auto output_dir = std::string("result/demo/") + model_name;
+    model.SetOutputDir(output_dir + "/");
+    system(("rm -rf " + output_dir).c_str());
+    system(("mkdir -p " + output_dir).c_str());
+    model.Calculate();
+    visit(model);
+  }
+  // Noise on a uniform state:
+  static Scalar GetNoise(Cell const& cell) {
+    return 1 + 0.1 * std::sin(cell.I() * 12.9898);
+  }
+  // The L2 norm of the residual at the last step over the one at the first,
+  // run from the noise:
+  template <class Configure>
+  Scalar GetDrop(std::string const& model_name, Configure&& configure) {
+    Scalar drop;
+    Run(model_name, GetNoise, [&](Model& model) {
+      model.SetResidualMonitor(1, 0);
+      configure(model);
+    }, [&](Model& model) {
+      auto const& residuals = model.GetResiduals();
+      drop = residuals.back().l2 / residuals.front().l2;
+    });
+    return drop;
+  }
+  // Largest |u| of the cell means at the end, run from a sine wave:
+  template <class Configure>
+  Scalar GetMaxValue(std::string const& model_name, Configure&& configure) {
+    auto sine = [](Cell const& cell) {
+      Scalar value = 0;
+      cell.Integrate([](auto const& point) {
+        return std::sin(point.X() * std::acos(0.0) * 4);
+      }, &value);
+      return value / cell.Measure();
+    };
+    Scalar max_value = 0;
+    Run(model_name, sine, configure, [&](Model& model) {
+      auto means = std::vector<Scalar>();
+      model.GetMeans(&means);
+      for (auto u : means) { max_value = std::max(max_value, std::abs(u)); }
+    });
+    return max_value;
+  }
+  // `n_steps_` local steps at `cfl`:
+  auto SetLocalTimeSteps(Scalar cfl) const {
+    return [=](Model& model) {
+      model.SetLocalTimeSteps(n_steps_, cfl, n_steps_);
+    };
+  }
+};
+TEST_F(SteadyTest, LocalTimeSteps) {
+  EXPECT_LT(GetDrop("steady_local", SetLocalTimeSteps(3)), 0.5);
+}
+// The monitor stops once the residual falls below the tolerance, and writes
+// the frame of that step, though the refresh rate would not:
+TEST_F(SteadyTest, ResidualMonitor) {
+  const Scalar tolerance = 0.5;
+  auto output_dir = std::string("result/demo/steady_monitor/");
+  Run("steady_monitor", GetNoise, [&](Model& model) {
+    SetLocalTimeSteps(3)(model);
+    model.SetResidualMonitor(1, tolerance);
+  }, [&](Model& model) {
+    auto const& residuals = model.GetResiduals();
+    auto const& steps = model.GetResidualSteps();
+    int n = residuals.size();
+    ASSERT_GE(n, 2);
+    EXPECT_LT(steps.back() + 1, n_steps_);
+    EXPECT_LE(residuals[n - 1].l2, tolerance * residuals[0].l2);
+    EXPECT_GT(residuals[n - 2].l2, tolerance * residuals[0].l2);
+    auto frame = [&](int i) {
+      return output_dir + "steady_monitor." + std::to_string(i) + ".vtu";
+    };
+    EXPECT_TRUE(std::ifstream(frame(steps.back() + 1)).good());
+    EXPECT_FALSE(std::ifstream(frame(n_steps_)).good());
+  });
+}
+// Each cycle speeds up the convergence of the steps it follows:
+TEST_F(SteadyTest, Multigrid) {
+  auto drop = GetDrop("steady_local", SetLocalTimeSteps(1));
+  EXPECT_LT(drop, 1);
+  EXPECT_LT(GetDrop("steady_multigrid", [&](Model& model) {
+    SetLocalTimeSteps(1)(model);
+    model.SetMultigrid(2);
+  }), drop / 2);
+}
+TEST_F(SteadyTest, PMultigrid) {
+  auto drop = GetDrop("steady_local", SetLocalTimeSteps(1));
+  EXPECT_LT(drop, 1);
+  EXPECT_LT(GetDrop("steady_p_multigrid", [&](Model& model) {
+    SetLocalTimeSteps(1)(model);
+    model.SetPMultigrid(2);
+  }), drop / 2);
+}
+// The implicit steps damp the wave towards its mean at a CFL number far
+// beyond the explicit ones, which barely damp it:
+TEST_F(SteadyTest, LuSgs) {
+  EXPECT_GT(GetMaxValue("steady_local", SetLocalTimeSteps(1)), 0.9);
+  EXPECT_LT(GetMaxValue("steady_lu_sgs", [&](Model& model) {
+    SetLocalTimeSteps(1000)(model);
+    model.SetLuSgsScheme(false);
+  }), 0.6);
+  EXPECT_LT(GetMaxValue("steady_lu_sgs_multicolor", [&](Model& model) {
+    SetLocalTimeSteps(1000)(model);
+    model.SetLuSgsScheme(true);
+  }), 0.6);
+}
+// The smoothed residual is stable at a CFL number the raw one is not:
+TEST_F(SteadyTest, ResidualSmoothing) {
+  EXPECT_FALSE(GetDrop("steady_local", SetLocalTimeSteps(6)) < 1);
+  EXPECT_LT(GetDrop("steady_smoothing", [&](Model& model) {
+    SetLocalTimeSteps(6)(model);
+    model.SetResidualSmoothing(2);
+  }), 0.5);
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
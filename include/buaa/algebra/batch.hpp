@@ -0,0 +1,121 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_ALGEBRA_BATCH_HPP_
+#define INCLUDE_BUAA_ALGEBRA_BATCH_HPP_
+
+#include <cstring>
+
+namespace buaa {
+namespace algebra {
+
+// Number of lanes of a `Pack`, i.e. `float`s in a SIMD register:
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+#else
+constexpr int kLanes = 8;
+#endif
+
+// `kLanes` small matrices interleaved entry by entry (AoSoA), so that the
+// same entry of all of them is contiguous and each kernel below runs the
+// same scalar code on every lane at once.
+template <class Scalar, int kRows, int kCols>
+struct alignas(64) Pack {
+  Scalar data[kRows][kCols][kLanes];
+  // Accessors:
+  static constexpr int Rows() { return kRows; }
+  static constexpr int Cols() { return kCols; }
+  Scalar& operator()(int i, int j, int lane) { return data[i][j][lane]; }
+  Scalar const& operator()(int i, int j, int lane) const {
+    return data[i][j][lane];
+  }
+  // Mutators:
+  void SetZero() { std::memset(data, 0, sizeof(data)); }
+  void SetIdentity() {
+    SetZero();
+    for (int i = 0; i < kRows && i < kCols; ++i) {
+      for (int l = 0; l < kLanes; ++l) { data[i][i][l] = 1; }
+    }
+  }
+  // Copy the leading `kRows x kCols` block of a matrix in or out of `lane`:
+  template <class Matrix>
+  void Load(int lane, Matrix const& matrix) {
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) { data[i][j][lane] = matrix(i, j); }
+    }
+  }
+  template <class Matrix>
+  void Store(int lane, Matrix* matrix) const {
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) { (*matrix)(i, j) = data[i][j][lane]; }
+    }
+  }
+};
+
+// c += a * b on each lane.
+template <class Scalar, int kRows, int kInner, int kCols>
+void MultiplyAdd(Pack<Scalar, kRows, kInner> const& a,
+                 Pack<Scalar, kInner, kCols> const& b,
+                 Pack<Scalar, kRows, kCols>* c) {
+  for (int i = 0; i < kRows; ++i) {
+    for (int k = 0; k < kInner; ++k) {
+      for (int j = 0; j < kCols; ++j) {
+        #pragma omp simd
+        for (int l = 0; l < kLanes; ++l) {
+          c->data[i][j][l] += a.data[i][k][l] * b.data[k][j][l];
+        }
+      }
+    }
+  }
+}
+// c = a * b on each lane.
+template <class Scalar, int kRows, int kInner, int kCols>
+void Multiply(Pack<Scalar, kRows, kInner> const& a,
+              Pack<Scalar, kInner, kCols> const& b,
+              Pack<Scalar, kRows, kCols>* c) {
+  c->SetZero();
+  MultiplyAdd(a, b, c);
+}
+// Invert the leading `kSize x kSize` block of `a` on each lane into `inv`, by
+// Gauss-Jordan elimination without pivoting, which is stable for the
+// symmetric positive definite matrices of the reconstruction.
+template <int kSize, class Scalar, int kRows, int kCols>
+void Invert(Pack<Scalar, kRows, kCols> const& a,
+            Pack<Scalar, kSize, kSize>* inv) {
+  static_assert(kSize <= kRows && kSize <= kCols);
+  Pack<Scalar, kSize, kSize> lu;
+  for (int i = 0; i < kSize; ++i) {
+    for (int j = 0; j < kSize; ++j) {
+      std::memcpy(lu.data[i][j], a.data[i][j], sizeof(lu.data[i][j]));
+    }
+  }
+  inv->SetIdentity();
+  for (int k = 0; k < kSize; ++k) {
+    alignas(64) Scalar pivot_inv[kLanes];
+    #pragma omp simd
+    for (int l = 0; l < kLanes; ++l) { pivot_inv[l] = 1 / lu.data[k][k][l]; }
+    for (int j = 0; j < kSize; ++j) {
+      #pragma omp simd
+      for (int l = 0; l < kLanes; ++l) {
+        lu.data[k][j][l] *= pivot_inv[l];
+        inv->data[k][j][l] *= pivot_inv[l];
+      }
+    }
+    for (int i = 0; i < kSize; ++i) {
+      if (i == k) { continue; }
+      alignas(64) Scalar factor[kLanes];
+      #pragma omp simd
+      for (int l = 0; l < kLanes; ++l) { factor[l] = lu.data[i][k][l]; }
+      for (int j = 0; j < kSize; ++j) {
+        #pragma omp simd
+        for (int l = 0; l < kLanes; ++l) {
+          lu.data[i][j][l] -= factor[l] * lu.data[k][j][l];
+          inv->data[i][j][l] -= factor[l] * inv->data[k][j][l];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace algebra
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_ALGEBRA_BATCH_HPP_
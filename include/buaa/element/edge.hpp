@@ -26,9 +26,7 @@ class Edge {
   // Constructors:
   Edge() = default;
   Edge(const NodeType& head, const NodeType& tail) : head_(head), tail_(tail) {
-    for (int i = 0; i < num_quad_points; ++i) {
-      quad_points_[i] = LocalToGlobal(gauss_.x_local[i]);
-    }
+    UpdateGeometry();
   }
   // Accessors:
   static constexpr int Degree() { return kDegree; }
@@ -39,6 +37,16 @@ class Edge {
   const NodeType& Tail() const { return tail_; }
   Scalar Measure() const { return (head_ - tail_).norm(); }
   PointType Center() const { return PointType((head_ + tail_) * 0.5); }
+  // Translate the edge, but not its nodes:
+  void Move(const PointType& begToEnd) {
+    for (auto& point : quad_points_) { point += begToEnd; }
+  }
+  // Recompute what depends on the coordinates of the nodes, after they moved:
+  void UpdateGeometry() {
+    for (int i = 0; i < num_quad_points; ++i) {
+      quad_points_[i] = LocalToGlobal(gauss_.x_local[i]);
+    }
+  }
   template <class Visitor>
   void ForEachQuadPoint(Visitor&& visitor) const {
     for (auto& point : quad_points_) { visitor(point); }
@@ -24,9 +24,7 @@ class Triangle<0> {
   Triangle() = default;
   Triangle(Id id, const NodeType& a, const NodeType& b, const NodeType& c)
       : id_(id), a_(a), b_(b), c_(c) { 
-      measure_ = GetMeasure(a, b, c);
-      center_ = PointType((a + b + c) / 3);
-      transform_mat_ << 1.0, 1.0, 1.0, a.X(), b.X(), c.X(), a.Y(), b.Y(), c.Y();
+      UpdateGeometry();
   }
   // Accessors:
   Id I() const { return id_; }
@@ -64,7 +62,17 @@ class Triangle<0> {
   // Geometric methods:
   Scalar Measure() const { return measure_; }
   const PointType& Center() const { return center_; }
-  void Move(const PointType& begToEnd) { center_ += begToEnd; }
+  // Translate the cell, but not its nodes:
+  void Move(const PointType& begToEnd) {
+    center_ += begToEnd;
+    transform_mat_.bottomRows<2>().colwise() += begToEnd;
+  }
+  // Recompute what depends on the coordinates of the nodes, after they moved:
+  void UpdateGeometry() {
+    measure_ = GetMeasure(a_, b_, c_);
+    center_ = PointType((a_ + b_ + c_) / 3);
+    transform_mat_ << 1.0, 1.0, 1.0, a_.X(), b_.X(), c_.X(), a_.Y(), b_.Y(), c_.Y();
+  }
   // Factorial
   static Scalar Factorial(int p) {
     int fac = 1;
@@ -103,8 +111,11 @@ class Triangle<1> : public Triangle<0> {
   Triangle() = default;
   Triangle(Id id, const NodeType& a, const NodeType& b, const NodeType& c) :
       Triangle<0>{id, a, b, c} {
-    dx_inv_ = GetDelta(A().X(), B().X(), C().X());
-    dy_inv_ = GetDelta(A().Y(), B().Y(), C().Y());
+    UpdateDelta();
+  }
+  void UpdateGeometry() {
+    Triangle<0>::UpdateGeometry();
+    UpdateDelta();
   }
   // Accessors:
   static constexpr int Degree() { return 1; }
@@ -130,6 +141,10 @@ class Triangle<1> : public Triangle<0> {
     return mat;
   }
  private:
+  void UpdateDelta() {
+    dx_inv_ = GetDelta(A().X(), B().X(), C().X());
+    dy_inv_ = GetDelta(A().Y(), B().Y(), C().Y());
+  }
   static Scalar GetDelta(Scalar a, Scalar b, Scalar c) {
     auto d = (std::max(std::max(a, b), c) - std::min(std::min(a, b), c)) * 0.5;
     return 1 / d;
@@ -148,16 +163,11 @@ class Triangle<2> : public Triangle<1> {
   Triangle() = default;
   Triangle(Id id, const NodeType& a, const NodeType& b, const NodeType& c) :
       Triangle<1>{id, a, b, c} {
-    Scalar measure_inv = 1 / Measure();
-    const_2 = Eigen::Matrix<Scalar, 3, 1>::Zero();
-    auto func = [&](const auto& point){
-      Eigen::Matrix<Scalar, 3, 1> col;
-      col << std::pow(F_0_0_0(point.X(), point.Y()), 2),
-             F_0_0_0(point.X(), point.Y()) * F_1_0_0(point.X(), point.Y()),
-             std::pow(F_1_0_0(point.X(), point.Y()), 2);
-      return col;
-    };
-    Integrate(func, &const_2); const_2 *= measure_inv;
+    UpdateConst2();
+  }
+  void UpdateGeometry() {
+    Triangle<1>::UpdateGeometry();
+    UpdateConst2();
   }
   // Accessors:
   static constexpr int Degree() { return 2; }
@@ -202,6 +212,18 @@ class Triangle<2> : public Triangle<1> {
     return mat;
   }
  private:
+  void UpdateConst2() {
+    Scalar measure_inv = 1 / Measure();
+    const_2 = Eigen::Matrix<Scalar, 3, 1>::Zero();
+    auto func = [&](const auto& point){
+      Eigen::Matrix<Scalar, 3, 1> col;
+      col << std::pow(F_0_0_0(point.X(), point.Y()), 2),
+             F_0_0_0(point.X(), point.Y()) * F_1_0_0(point.X(), point.Y()),
+             std::pow(F_1_0_0(point.X(), point.Y()), 2);
+      return col;
+    };
+    Integrate(func, &const_2); const_2 *= measure_inv;
+  }
   Eigen::Matrix<Scalar, 3, 1> const_2;
 };
 
@@ -214,17 +236,11 @@ class Triangle<3> : public Triangle<2> {
   Triangle() = default;
   Triangle(Id id, const NodeType& a, const NodeType& b, const NodeType& c) :
       Triangle<2>{id, a, b, c} {
-    Scalar measure_inv = 1 / Measure();
-    const_3 = Eigen::Matrix<Scalar, 4, 1>::Zero();
-    auto func = [&](const auto& point){
-      Eigen::Matrix<Scalar, 4, 1> col;
-      col << std::pow(F_0_0_0(point.X(), point.Y()), 3),
-             std::pow(F_0_0_0(point.X(), point.Y()), 2) * F_1_0_0(point.X(), point.Y()),
-             F_0_0_0(point.X(), point.Y()) * std::pow(F_1_0_0(point.X(), point.Y()), 2),
-             std::pow(F_1_0_0(point.X(), point.Y()), 3);
-      return col;
-    };
-    Integrate(func, &const_3); const_3 *= measure_inv;
+    UpdateConst3();
+  }
+  void UpdateGeometry() {
+    Triangle<2>::UpdateGeometry();
+    UpdateConst3();
   }
   // Accessors:
   static constexpr int Degree() { return 3; }
@@ -295,6 +311,19 @@ class Triangle<3> : public Triangle<2> {
     return mat;
   }
  private:
+  void UpdateConst3() {
+    Scalar measure_inv = 1 / Measure();
+    const_3 = Eigen::Matrix<Scalar, 4, 1>::Zero();
+    auto func = [&](const auto& point){
+      Eigen::Matrix<Scalar, 4, 1> col;
+      col << std::pow(F_0_0_0(point.X(), point.Y()), 3),
+             std::pow(F_0_0_0(point.X(), point.Y()), 2) * F_1_0_0(point.X(), point.Y()),
+             F_0_0_0(point.X(), point.Y()) * std::pow(F_1_0_0(point.X(), point.Y()), 2),
+             std::pow(F_1_0_0(point.X(), point.Y()), 3);
+      return col;
+    };
+    Integrate(func, &const_3); const_3 *= measure_inv;
+  }
   Eigen::Matrix<Scalar, 4, 1> const_3;
 };
 
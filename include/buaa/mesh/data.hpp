@@ -3,6 +3,7 @@
 #define INCLUDE_BUAA_ELEMENT_DATA_HPP_
 
 #include <array>
+#include <type_traits>
 
 #include "buaa/element/point.hpp"
 
@@ -24,6 +25,33 @@ struct Data {
 
 using Empty = Data<0, 0, 0>;
 
+// Number of variables reconstructed on each cell, i.e. the number of columns
+// of `CellData::coefficients`, or 1 if `CellData` has no coefficients.
+template <class CellData, class = void>
+struct CountVariables {
+  static constexpr int value = 1;
+};
+template <class CellData>
+struct CountVariables<CellData, std::void_t<decltype(CellData::coefficients)>> {
+  static constexpr int value = decltype(CellData::coefficients)::ColsAtCompileTime;
+};
+
+// How the VR operators are kept, chosen by `CellData::kVrStorage`:
+enum class VrStorage {
+  kOwned,       // each cell and edge owns its matrices
+  kMatrixFree,  // edges own no matrix, it is applied from the geometry
+  kShared,      // translates of a cell (or a pair of cells) share a matrix
+  kBatched,     // only the packs of the VR batch hold them, built in place
+};
+template <class CellData, class = void>
+struct VrStorageOf {
+  static constexpr VrStorage value = VrStorage::kOwned;
+};
+template <class CellData>
+struct VrStorageOf<CellData, std::void_t<decltype(CellData::kVrStorage)>> {
+  static constexpr VrStorage value = CellData::kVrStorage;
+};
+
 }  // namespace mesh
 }  // namespace buaa
 
@@ -70,6 +70,22 @@ class Mesh {
     #pragma omp parallel for
     for (auto& cell_ptr : id_to_cell_) { visitor(*cell_ptr); }
   }
+  // Fold `visitor(cell)` of all cells into `init` by `reduce`, in parallel.
+  template <class T, class Visitor, class Reduce>
+  T ReduceCellsParallel(T init, Visitor&& visitor, Reduce&& reduce) const {
+    T result = init;
+    #pragma omp parallel
+    {
+      T local = init;
+      #pragma omp for nowait
+      for (auto& cell_ptr : id_to_cell_) {
+        local = reduce(local, visitor(*cell_ptr));
+      }
+      #pragma omp critical
+      result = reduce(result, local);
+    }
+    return result;
+  }
   // Emplace primitive objects.
   Node* EmplaceNode(NodeId i, Scalar x, Scalar y) {
     auto node_unique_ptr = std::make_unique<Node>(i, x, y);
@@ -94,6 +110,10 @@ class Mesh {
     }
   }
   Node* GetNode(NodeId i) const { return id_to_node_.at(i).get(); }
+  // Move a node in place, leaving the geometry of its cells and edges stale:
+  void MoveNode(NodeId i, const Point& displacement) {
+    *id_to_node_.at(i) += displacement;
+  }
   Cell* EmplaceCell(CellId i, std::initializer_list<NodeId> nodes) {
     auto* p = nodes.begin();
     auto* a = GetNode(p[0]);
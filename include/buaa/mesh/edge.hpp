@@ -3,6 +3,7 @@
 #define INCLUDE_BUAA_MESH_EDGE_HPP_
 
 #include <array>
+#include <type_traits>
 #include <utility>
 
 #include <Eigen/Dense>
@@ -35,10 +36,14 @@ class Edge : public element::Edge<kDegree> {
   using Node = element::Node<2>;
   using Matrix = typename Base::Matrix;
   using Data = EdgeData;
+  static constexpr VrStorage kVrStorage = VrStorageOf<CellData>::value;
+  static constexpr bool kStoresBmat = (kVrStorage == VrStorage::kOwned);
+  using BmatStorage = std::conditional_t<kStoresBmat, Matrix,
+                                         Eigen::Matrix<Scalar, 0, 0>>;
   // Constructors:
   Edge() = default;
   Edge(const Node& head, const Node& tail) : Base(head, tail) {
-    b_matrix = Matrix::Zero();
+    b_matrix.setZero();
   }
   // Accessors:
   Cell* GetPositiveSide() const { return positive_side_; }
@@ -75,10 +80,34 @@ class Edge : public element::Edge<kDegree> {
       }, &b_matrix);
     }
   }
+  // Add the leading `kRows` rows of `b_matrix`, oriented for `cell`, times the
+  // `coefficients` of the cell on the other side to `value`. The matrix is
+  // not formed: its factors are evaluated at each quadrature point, with the
+  // other cell evaluated at `point + shift` across periodic boundaries.
+  template <int kRows, class Coefficients, class Value>
+  void ApplyBmat(const Cell& cell, const Point& shift,
+                 const Coefficients& coefficients, Value* value) const {
+    const Cell& that = (&cell == positive_side_) ? *negative_side_ : *positive_side_;
+    Scalar normal[2] = {GetNormalX(), GetNormalY()};
+    Scalar p[kDegree+1]; Cell::GetPArray(distance, kDegree, p);
+    using Trace = Eigen::Matrix<Scalar, kDegree+1, Coefficients::ColsAtCompileTime>;
+    using Result = Eigen::Matrix<Scalar, kRows, Coefficients::ColsAtCompileTime>;
+    Result sum = Result::Zero();
+    this->Integrate([&](const Point& point) {
+      Scalar coord[] = {point.X(), point.Y()};
+      Scalar coord_that[] = {point.X() + shift.X(), point.Y() + shift.Y()};
+      Trace trace = that.GetFuncTable(that, coord_that, normal).transpose() *
+                    coefficients;
+      for (int k = 0; k != kDegree+1; ++k) { trace.row(k) *= p[k]; }
+      return Result(cell.GetFuncTable(cell, coord, normal).template topRows<kRows>() *
+                    trace);
+    }, &sum);
+    *value += sum;
+  }
   // Data:
   Scalar distance;
   Data data;
-  Matrix b_matrix;
+  BmatStorage b_matrix;
 
  private:
   Cell* positive_side_{nullptr};
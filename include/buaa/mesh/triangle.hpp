@@ -4,6 +4,7 @@
 
 #include <array>
 #include <string>
+#include <type_traits>
 
 #include <Eigen/Dense>
 
@@ -26,6 +27,17 @@ template <int kDegree, class EdgeData, class CellData>
 class Triangle : public element::Triangle<kDegree> {
  private:
   static constexpr int nCoef = (kDegree+1) * (kDegree+2) / 2 - 1;
+  static constexpr int nVar = CountVariables<CellData>::value;
+  // Entries of the inverted leading blocks of degrees 1, ..., kDegree-1:
+  static constexpr int LowOffset(int degree) {
+    int n = 0;
+    for (int p = 1; p < degree; ++p) {
+      int m = (p+1) * (p+2) / 2 - 1;
+      n += m * m;
+    }
+    return n;
+  }
+  static constexpr int nLow = LowOffset(kDegree);
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   // Types:
@@ -37,8 +49,17 @@ class Triangle : public element::Triangle<kDegree> {
   using Matrix = Eigen::Matrix<Scalar, nCoef, nCoef>;
   using Vector = Eigen::Matrix<Scalar, nCoef, 1>;
   using Matrix3V = Eigen::Matrix<Scalar, nCoef, 3>;
+  using Coefficients = Eigen::Matrix<Scalar, nCoef, nVar>;
+  using Row = Eigen::Matrix<Scalar, 1, nVar>;
   using BasisF = Eigen::Matrix<Scalar, nCoef, kDegree+1>;
+  using LowInv = std::array<Scalar, nLow>;
   using Data = CellData;
+  // Shared and batched operators live outside of the cells:
+  static constexpr bool kOwnsVr =
+      (VrStorageOf<CellData>::value == VrStorage::kOwned ||
+       VrStorageOf<CellData>::value == VrStorage::kMatrixFree);
+  template <class Owned, class Shared>
+  using VrMember = std::conditional_t<kOwnsVr, Owned, Shared>;
   // Constructors:
   Triangle() = default;
   Triangle(Id id, const NodeType& a, const NodeType& b, const NodeType& c,
@@ -48,6 +69,17 @@ class Triangle : public element::Triangle<kDegree> {
   Triangle& operator=(const Triangle&);
   // Accessors:
   static constexpr int CountCoef() { return nCoef; }
+  static constexpr int CountCoef(int degree) {
+    return (degree+1) * (degree+2) / 2 - 1;
+  }
+  static constexpr int CountVariables() { return nVar; }
+  // The basis is hierarchical, so a cell may use only its first
+  // `CountCoef(ActiveDegree())` modes.
+  int ActiveDegree() const { return active_degree_; }
+  void SetActiveDegree(int degree) {
+    active_degree_ = degree;
+    data.coefficients.bottomRows(nCoef - CountCoef(degree)).setZero();
+  }
   bool Contains(const EdgeType* edge) const {
     for (int i = 0; i < 3; ++i) {
       if (edges_[i] == edge) { return true; }
@@ -58,28 +90,80 @@ class Triangle : public element::Triangle<kDegree> {
   template <class Visitor>
   void ForEachEdge(Visitor&& visitor) { for(auto& e : edges_) {visitor(*e);} }
   // Initialize VR Matrix and Vector:
-  void InitializeAmatInv() {
+  void InitializeAmatInv() { BuildAmatInv(&a_matrix_inv, &a_matrix_low_inv); }
+  void BuildAmatInv(Matrix* a_matrix_inv, LowInv* a_matrix_low_inv) const {
+    Matrix a_matrix = BuildAmat();
+    *a_matrix_inv = a_matrix.inverse();
+    // Derivatives above degree p vanish on degree-p modes, so the leading
+    // block of `a_matrix` is the VR matrix of degree p:
+    for (int p = 1; p < kDegree; ++p) {
+      int n = CountCoef(p);
+      Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> low(
+          a_matrix_low_inv->data() + LowOffset(p), n, n);
+      low = a_matrix.topLeftCorner(n, n).inverse();
+    }
+  }
+  Matrix BuildAmat() const {
     Matrix a_matrix = Matrix::Zero();
-    ForEachEdge([&](EdgeType& edge) {
+    for (auto* edge : edges_) {
       Matrix temp = Matrix::Zero();
-      Scalar normal[2] = {edge.GetNormalX(), edge.GetNormalY()};
-      edge.Integrate([&](const PointType& point) {
-        return GetMatAt(point.X(), point.Y(), *this, edge.distance, normal);
+      Scalar normal[2] = {edge->GetNormalX(), edge->GetNormalY()};
+      edge->Integrate([&](const PointType& point) {
+        return GetMatAt(point.X(), point.Y(), *this, edge->distance, normal);
       }, &temp);
       a_matrix += temp;
-    });
-    a_matrix_inv = a_matrix.inverse();
+    }
+    return a_matrix;
+  }
+  // Inverse of the VR matrix restricted to the modes of degree `kP`:
+  template <int kP>
+  auto GetAmatInv() const { return GetAmatInv<kP>(a_matrix_inv, a_matrix_low_inv); }
+  template <int kP>
+  auto GetAmatInv() {
+    constexpr int n = CountCoef(kP);
+    using Block = Eigen::Matrix<Scalar, n, n>;
+    if constexpr (kP == kDegree) {
+      return Eigen::Map<Block>(a_matrix_inv.data());
+    } else {
+      return Eigen::Map<Block>(a_matrix_low_inv.data() + LowOffset(kP));
+    }
+  }
+  template <int kP>
+  static auto GetAmatInv(const Matrix& a_matrix_inv, const LowInv& a_matrix_low_inv) {
+    constexpr int n = CountCoef(kP);
+    using Block = const Eigen::Matrix<Scalar, n, n>;
+    if constexpr (kP == kDegree) {
+      return Eigen::Map<Block>(a_matrix_inv.data());
+    } else {
+      return Eigen::Map<Block>(a_matrix_low_inv.data() + LowOffset(kP));
+    }
   }
   void InitializeBvecMat() {
-    b_vector_mat = Matrix3V::Zero();
+    b_vector = Coefficients::Zero();
+    BuildBvecMat(&b_vector_mat);
+  }
+  void BuildBvecMat(Matrix3V* b_vector_mat) const {
     for (int i = 0; i < 3; ++i) {
       Vector temp = Vector::Zero();
       edges_[i]->Integrate([&](const PointType& point) {
         return GetVecAt(point.X(), point.Y(), edges_[i]->distance);
       }, &temp);
-      b_vector_mat.col(i) = temp;
+      b_vector_mat->col(i) = temp;
     }
   }
+  // `b_matrix` of `edge`, across which `that` is seen shifted by `shift`,
+  // with the rows belonging to this cell:
+  Matrix BuildBmat(const EdgeType& edge, const CellType& that,
+                   const PointType& shift) const {
+    Matrix b_matrix = Matrix::Zero();
+    Scalar normal[2] = {edge.GetNormalX(), edge.GetNormalY()};
+    edge.Integrate([&](const PointType& point) {
+      return GetMatAt(point.X(), point.Y(), that, edge.distance, shift, normal);
+    }, &b_matrix);
+    // `GetMatAt` gives the rows to the cell of larger id:
+    if (Base::I() < that.I()) { b_matrix.transposeInPlace(); }
+    return b_matrix;
+  }
   static void GetPArray(Scalar distance, int degree, Scalar* p) {
    for (int i = 0; i <= degree; ++i)
       p[i] = std::pow(distance, 2*i-1) / std::pow(Factorial(i), 2);
@@ -120,20 +204,30 @@ class Triangle : public element::Triangle<kDegree> {
   Vector GetVecAt(Scalar x, Scalar y, Scalar distance) const {
     return Functions(x, y) / distance;
   }
-  // Polynomial:
-  Scalar Polynomial(const PointType& point) const {
-    return this->Functions(point.X(), point.Y()).transpose() * data.coefficients;
+  // Polynomial (one column per variable):
+  Row Polynomial(const PointType& point) const {
+    return Polynomial(point, active_degree_);
+  }
+  Row Polynomial(const PointType& point, int degree) const {
+    if (degree == kDegree) {
+      return this->Functions(point.X(), point.Y()).transpose() * data.coefficients;
+    }
+    int n = CountCoef(degree);
+    return this->Functions(point.X(), point.Y()).head(n).transpose() *
+           data.coefficients.topRows(n);
   }
   // Data:
   static std::array<std::string, CellData::CountScalars()> scalar_names;
   static std::array<std::string, CellData::CountVectors()> vector_names;
   Data data;
-  Matrix a_matrix_inv;
-  Vector b_vector;
-  Matrix3V b_vector_mat;
+  VrMember<Matrix, Eigen::Matrix<Scalar, 0, 0>> a_matrix_inv;
+  VrMember<LowInv, std::array<Scalar, 0>> a_matrix_low_inv;
+  Coefficients b_vector;
+  VrMember<Matrix3V, Eigen::Matrix<Scalar, 0, 3>> b_vector_mat;
 
  private:
   std::array<EdgeType*, 3> edges_;
+  int active_degree_{kDegree};
 };
 
 template <int kDegree, class EdgeData, class CellData>
@@ -2,6 +2,8 @@
 #ifndef INCLUDE_BUAA_RIEMANN_AUSM_HPP_
 #define INCLUDE_BUAA_RIEMANN_AUSM_HPP_
 
+#include <cmath>
+
 #include "buaa/riemann/types.hpp"
 
 namespace buaa {
@@ -11,15 +13,13 @@ template <class GasModel, int kDim = 1>
 class Ausm;
 
 template <class GasModel>
-class Ausm<GasModel, 2> {
+class Ausm<GasModel, 2> : public NormalFrame<Ausm<GasModel, 2>, GasModel> {
  public:
-  // Types:
-  using Gas = GasModel;
-  using FluxType = Flux<2>;
-  using ConservativeType = Conservative<2>;
-  using PrimitiveType = Primitive<2>;
-  using State = PrimitiveType;
-  using Vector = typename State::Vector;
+  using Base = NormalFrame<Ausm, GasModel>;
+  using Base::GetFlux;
+  using typename Base::Gas;
+  using typename Base::FluxType;
+  using typename Base::State;
   // Get F on T Axia
   static FluxType GetFlux(State const& left, State const& right) {
     FluxType flux_positive = GetPositiveFlux(left);
@@ -27,45 +27,60 @@ class Ausm<GasModel, 2> {
     flux_positive += flux_negative;
     return flux_positive;
   }
-  // Get F on normal T Axia
-  static FluxType GetFlux(ConservativeType const& left,
-                          ConservativeType const& right,
-                          Vector const& normal) {
-    auto left__primitive = Gas::ConservativeToPrimitive(left);
-    auto right_primitive = Gas::ConservativeToPrimitive(right);
-    GlobalToNormal(&(left__primitive.momentum), normal);
-    GlobalToNormal(&(right_primitive.momentum), normal);
-    auto flux = GetFluxOnTimeAxis(left__primitive, right_primitive);
-    NormalToGlobal(&(flux.momentum), normal);
-    return flux;
-  }
-  // Get F of U
-  static FluxType GetFlux(State const& state) {
-    auto rho_u = state.rho() * state.u();
-    auto rho_v = state.rho() * state.v();
-    auto rho_u_u = rho_u * state.u();
-    return {rho_u, rho_u_u + state.p(), rho_v * state.u(),
-            state.u() * (state.p() * Gas::GammaOverGammaMinusOne()
-                       + 0.5 * (rho_u_u + rho_v * state.v()))};
-  }
-  static void GlobalToNormal(Vector* v, Vector const& n) {
-    /* Calculate the normal component: */
-    auto v_n = v->dot(n);
-    /* Calculate the tangential component:
-       auto t = Vector{ -n[1], n[0] };
-       auto v_t = v->Dot(t);
-    */
-    (*v)(1) = n(0) * (*v)(1) - n(1) * (*v)(0);
-    /* Write the normal component: */
-    (*v)(0) = v_n;
-  }
-  static void NormalToGlobal(Vector* v, Vector const& n) {
-    auto v_0 = (*v)(0) * n(0) - (*v)(1) * n(1);
-    (*v)(1) = (*v)(0) * n(1) + (*v)(1) * n(0);
-    (*v)(0) = v_0;
+  // Get F on the normals (n_x, n_y) of `n` points from the conservative U_l
+  // and U_r there, with selects in place of the branches on Mach numbers, so
+  // that the points run in SIMD lanes:
+  static void GetFluxes(int n, ConstArrays<4> left,
+                        ConstArrays<4> right,
+                        ConstArrays<2> normal, Arrays<4> fluxes) {
+    auto [rho_l, rho_u_l, rho_v_l, rho_e_l] = left;
+    auto [rho_r, rho_u_r, rho_v_r, rho_e_r] = right;
+    auto [n_x, n_y] = normal;
+    auto [f_0, f_1, f_2, f_3] = fluxes;
+    #pragma omp simd
+    for (int i = 0; i < n; ++i) {
+      // Scalars rather than an array, which `omp simd` can't privatize:
+      Scalar mass = 0, normal = 0, tangent = 0, energy = 0;
+      AddSplitFlux<+1>(rho_l[i], rho_u_l[i], rho_v_l[i], rho_e_l[i],
+                       n_x[i], n_y[i], mass, normal, tangent, energy);
+      AddSplitFlux<-1>(rho_r[i], rho_u_r[i], rho_v_r[i], rho_e_r[i],
+                       n_x[i], n_y[i], mass, normal, tangent, energy);
+      f_0[i] = mass;
+      f_1[i] = normal * n_x[i] - tangent * n_y[i];
+      f_2[i] = normal * n_y[i] + tangent * n_x[i];
+      f_3[i] = energy;
+    }
   }
-  
+
  private:
+  // Add the positive (`kSign` = +1) or negative (-1) part of F of a
+  // conservative U to the flux, in the frame of normal (n_x, n_y):
+  template <int kSign>
+  static void AddSplitFlux(Scalar rho, Scalar rho_u, Scalar rho_v,
+                           Scalar rho_e, Scalar n_x, Scalar n_y,
+                           Scalar& mass, Scalar& normal, Scalar& tangent,
+                           Scalar& energy) {
+    constexpr Scalar s = kSign;
+    Scalar rho_inv = rho > 0 ? 1 / rho : 0;
+    Scalar u = rho_u * rho_inv, v = rho_v * rho_inv;
+    Scalar p = (rho_e - 0.5f * rho * (u * u + v * v)) * Gas::GammaMinusOne();
+    p = p > 0 ? p : 0;
+    Scalar u_n = u * n_x + v * n_y, u_t = v * n_x - u * n_y;
+    Scalar a = std::sqrt(Gas::Gamma() * p * rho_inv);
+    Scalar mach = a > 0 ? u_n / a : 0;
+    bool subsonic = std::abs(u_n) <= a;
+    bool upwind = s * u_n > 0;
+    // a * M+ (or a * M-), and p+ (or p-):
+    Scalar a_mach = subsonic ? s * a * (mach + s) * (mach + s) * 0.25f
+                             : (upwind ? u_n : 0);
+    Scalar p_split = subsonic ? p * (1 + s * mach) * 0.5f : (upwind ? p : 0);
+    Scalar h = a * a / Gas::GammaMinusOne() + (u_n * u_n + u_t * u_t) * 0.5f;
+    Scalar m = rho * a_mach;
+    mass += m;
+    normal += m * u_n + p_split;
+    tangent += m * u_t;
+    energy += m * h;
+  }
   static FluxType GetPositiveFlux(State const& state) {
     Scalar p_positive = state.p();
     Scalar a = Gas::GetSpeedOfSound(state);
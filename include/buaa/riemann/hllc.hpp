@@ -0,0 +1,77 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_RIEMANN_HLLC_HPP_
+#define INCLUDE_BUAA_RIEMANN_HLLC_HPP_
+
+#include <algorithm>
+#include <cmath>
+
+#include "buaa/riemann/types.hpp"
+
+namespace buaa {
+namespace riemann {
+
+template <class GasModel, int kDim = 1>
+class Hllc;
+
+// HLLC (Toro, Spruce and Speares): HLL with the contact wave restored, so
+// that contacts and shear layers are resolved without the dissipation of
+// AUSM. The outer wave speeds are estimated as by Davis.
+template <class GasModel>
+class Hllc<GasModel, 2> : public NormalFrame<Hllc<GasModel, 2>, GasModel> {
+ public:
+  using typename NormalFrame<Hllc, GasModel>::Gas;
+  // Get the speeds of the left wave, the contact and the right wave from
+  // the normal components of U_l and U_r, at which the pressures of the two
+  // star states U*_l and U*_r agree:
+  static void GetWaveSpeeds(Scalar rho_l, Scalar u_l, Scalar p_l,
+                            Scalar rho_r, Scalar u_r, Scalar p_r,
+                            Scalar& s_l, Scalar& s_star, Scalar& s_r) {
+    Scalar a_l = std::sqrt(Gas::Gamma() * p_l / (rho_l > 0 ? rho_l : 1));
+    Scalar a_r = std::sqrt(Gas::Gamma() * p_r / (rho_r > 0 ? rho_r : 1));
+    s_l = std::min(u_l - a_l, u_r - a_r);
+    s_r = std::max(u_l + a_l, u_r + a_r);
+    // Mass fluxes through the outer waves:
+    Scalar m_l = rho_l * (s_l - u_l), m_r = rho_r * (s_r - u_r);
+    Scalar m = m_l - m_r;
+    s_star = (p_r - p_l + m_l * u_l - m_r * u_r) / (m < 0 ? m : -1);
+    s_star = m < 0 ? s_star : 0;
+  }
+  // Set F on T Axia at each of `n` points by U_l and U_r there, given as
+  // {rho, u, v, p}, with selects in place of branches, so that the points
+  // run in SIMD lanes:
+  static void GetFluxesOnNormal(int n, ConstArrays<4> left,
+                                ConstArrays<4> right, Arrays<4> fluxes) {
+    auto [rho_ls, u_ls, v_ls, p_ls] = left;
+    auto [rho_rs, u_rs, v_rs, p_rs] = right;
+    auto [masses, normals, tangents, energies] = fluxes;
+    #pragma omp simd
+    for (int i = 0; i < n; ++i) {
+      Scalar rho_l = rho_ls[i], u_l = u_ls[i], v_l = v_ls[i], p_l = p_ls[i];
+      Scalar rho_r = rho_rs[i], u_r = u_rs[i], v_r = v_rs[i], p_r = p_rs[i];
+      Scalar s_l, s_star, s_r;
+      GetWaveSpeeds(rho_l, u_l, p_l, rho_r, u_r, p_r, s_l, s_star, s_r);
+      // The side of the contact the T axis is on, and the weight of the jump
+      // s (U* - U) from F to F* on it, which is 0 outside the outer wave:
+      bool on_left = 0 <= s_star;
+      Scalar rho = on_left ? rho_l : rho_r, u = on_left ? u_l : u_r;
+      Scalar v = on_left ? v_l : v_r, p = on_left ? p_l : p_r;
+      Scalar s = on_left ? s_l : s_r;
+      Scalar w = (on_left ? -s : s) > 0 ? s : 0;
+      Scalar e = p / Gas::GammaMinusOne() + 0.5f * rho * (u * u + v * v);
+      Scalar gap = s - s_star, lag = s - u;
+      Scalar ratio = lag / (gap != 0 ? gap : 1);
+      Scalar p_rate = p / (lag != 0 ? lag : 1);
+      Scalar rho_star = rho * ratio;
+      Scalar e_star = ratio * (e + (s_star - u) * (rho * s_star + p_rate));
+      masses[i] = rho * u + w * (rho_star - rho);
+      normals[i] = rho * u * u + p + w * (rho_star * s_star - rho * u);
+      tangents[i] = rho * u * v + w * (rho_star - rho) * v;
+      energies[i] = u * (e + p) + w * (e_star - e);
+    }
+  }
+};
+
+}  //  namespace riemann
+}  //  namespace buaa
+
+#endif  //  INCLUDE_BUAA_RIEMANN_HLLC_HPP_
@@ -2,24 +2,55 @@
 #ifndef INCLUDE_BUAA_RIEMANN_LINEAR_HPP_
 #define INCLUDE_BUAA_RIEMANN_LINEAR_HPP_
 
+#include <cmath>
+
 #include "buaa/riemann/types.hpp"
 
 namespace buaa {
 namespace riemann {
 
+// Advection along x, whose speed on a normal (n_x, n_y) is `a` = n_x:
 class Linear {
  public:
   using State = Scalar;
   using Flux = Scalar;
+  using FluxType = Flux;
+  using Vector = Matrix<Scalar, 2, 1>;
   // Get F of U_l and U_r
   static Scalar GetFlux(Scalar const& left, Scalar const& right, Scalar const& a) {
     if (0 < a) { return left * a; }
     else { return right* a; }
   }
+  static Scalar GetFlux(Scalar const& left, Scalar const& right,
+                        Vector const& normal) {
+    return GetFlux(left, right, normal(0));
+  }
+  // Get F of U_l and U_r on the normals (n_x, n_y) of `n` points, of which
+  // only n_x is read:
+  static void GetFluxes(int n, ConstArrays<1> left,
+                        ConstArrays<1> right, ConstArrays<2> normal,
+                        Arrays<1> fluxes) {
+    auto* __restrict f = fluxes[0];
+    auto* a = normal[0];
+    #pragma omp simd
+    for (int i = 0; i < n; ++i) {
+      f[i] = (0 < a[i] ? left[0][i] : right[0][i]) * a[i];
+    }
+  }
   // Get F of U
   static Scalar GetFlux(Scalar const& state, Scalar const& a) {
     return state * a;
   }
+  static Scalar GetFlux(Scalar const& state, Vector const& normal) {
+    return GetFlux(state, normal(0));
+  }
+  // Get the largest wave speed of U
+  static Scalar GetMaxSpeed(Scalar const& state, Scalar const& a) {
+    return std::abs(a);
+  }
+  static Scalar GetMaxSpeed(Scalar const& state, Vector const& normal) {
+    return GetMaxSpeed(state, normal(0));
+  }
 };
 
 }  // namespace riemann
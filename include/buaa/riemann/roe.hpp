@@ -0,0 +1,88 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_RIEMANN_ROE_HPP_
+#define INCLUDE_BUAA_RIEMANN_ROE_HPP_
+
+#include <cmath>
+
+#include "buaa/riemann/types.hpp"
+
+namespace buaa {
+namespace riemann {
+
+template <class GasModel, int kDim = 1>
+class Roe;
+
+// Roe's linearization about the Roe average of U_l and U_r, with Harten's
+// entropy fix on the acoustic waves, whose speeds |lambda| below
+// `EntropyFix()` times the speed of sound are smoothed to keep expansion
+// shocks out of sonic points.
+template <class GasModel>
+class Roe<GasModel, 2> : public NormalFrame<Roe<GasModel, 2>, GasModel> {
+ public:
+  using typename NormalFrame<Roe, GasModel>::Gas;
+  // Constants:
+  static constexpr Scalar EntropyFix() { return 0.1; }
+  // Set F on T Axia at each of `n` points by U_l and U_r there, given as
+  // {rho, u, v, p}, with selects in place of branches, so that the points
+  // run in SIMD lanes:
+  static void GetFluxesOnNormal(int n, ConstArrays<4> left,
+                                ConstArrays<4> right, Arrays<4> fluxes) {
+    auto [rho_ls, u_ls, v_ls, p_ls] = left;
+    auto [rho_rs, u_rs, v_rs, p_rs] = right;
+    auto [masses, normals, tangents, energies] = fluxes;
+    #pragma omp simd
+    for (int i = 0; i < n; ++i) {
+      Scalar rho_l = rho_ls[i], u_l = u_ls[i], v_l = v_ls[i], p_l = p_ls[i];
+      Scalar rho_r = rho_rs[i], u_r = u_rs[i], v_r = v_rs[i], p_r = p_rs[i];
+      Scalar e_l = p_l / Gas::GammaMinusOne() +
+                   0.5f * rho_l * (u_l * u_l + v_l * v_l);
+      Scalar e_r = p_r / Gas::GammaMinusOne() +
+                   0.5f * rho_r * (u_r * u_r + v_r * v_r);
+      // Roe average, weighted by sqrt(rho):
+      Scalar sqrt_l = std::sqrt(rho_l), sqrt_r = std::sqrt(rho_r);
+      Scalar weight = sqrt_l + sqrt_r;
+      Scalar weight_inv = Scalar(weight > 0) / (weight > 0 ? weight : 1);
+      Scalar rho = sqrt_l * sqrt_r;
+      Scalar u = (sqrt_l * u_l + sqrt_r * u_r) * weight_inv;
+      Scalar v = (sqrt_l * v_l + sqrt_r * v_r) * weight_inv;
+      // sqrt(rho) * H = (E + p) / sqrt(rho):
+      Scalar h_l = (e_l + p_l) * Scalar(sqrt_l > 0) / (sqrt_l > 0 ? sqrt_l : 1);
+      Scalar h_r = (e_r + p_r) * Scalar(sqrt_r > 0) / (sqrt_r > 0 ? sqrt_r : 1);
+      Scalar h = (h_l + h_r) * weight_inv;
+      Scalar q = 0.5f * (u * u + v * v);
+      Scalar a_a = Gas::GammaMinusOne() * (h - q);
+      a_a = a_a > 0 ? a_a : 0;
+      Scalar a = std::sqrt(a_a);
+      Scalar a_a_inv = Scalar(a_a > 0) / (a_a > 0 ? a_a : 1);
+      // Strengths of the waves:
+      Scalar d_rho = rho_r - rho_l, d_u = u_r - u_l, d_p = p_r - p_l;
+      Scalar alpha_1 = (d_p - rho * a * d_u) * 0.5f * a_a_inv;
+      Scalar alpha_2 = d_rho - d_p * a_a_inv;
+      Scalar alpha_3 = rho * (v_r - v_l);
+      Scalar alpha_4 = (d_p + rho * a * d_u) * 0.5f * a_a_inv;
+      // Speeds of the waves, fixed:
+      Scalar delta = EntropyFix() * a;
+      auto fix = [delta](Scalar lambda) {
+        lambda = std::abs(lambda);
+        Scalar smooth = (lambda * lambda + delta * delta) * 0.5f /
+                        (delta > 0 ? delta : 1);
+        return lambda < delta ? smooth : lambda;
+      };
+      Scalar k_1 = fix(u - a) * alpha_1, k_4 = fix(u + a) * alpha_4;
+      Scalar k_2 = std::abs(u) * alpha_2, k_3 = std::abs(u) * alpha_3;
+      masses[i] = 0.5f * (rho_l * u_l + rho_r * u_r - (k_1 + k_2 + k_4));
+      normals[i] = 0.5f * (rho_l * u_l * u_l + p_l + rho_r * u_r * u_r + p_r -
+                           (k_1 * (u - a) + k_2 * u + k_4 * (u + a)));
+      tangents[i] = 0.5f * (rho_l * u_l * v_l + rho_r * u_r * v_r -
+                            ((k_1 + k_2 + k_4) * v + k_3));
+      energies[i] = 0.5f * (u_l * (e_l + p_l) + u_r * (e_r + p_r) -
+                            (k_1 * (h - u * a) + k_2 * q + k_3 * v +
+                             k_4 * (h + u * a)));
+    }
+  }
+};
+
+}  //  namespace riemann
+}  //  namespace buaa
+
+#endif  //  INCLUDE_BUAA_RIEMANN_ROE_HPP_
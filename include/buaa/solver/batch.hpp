@@ -0,0 +1,229 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_BATCH_HPP_
+#define INCLUDE_BUAA_SOLVER_BATCH_HPP_
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "buaa/algebra/batch.hpp"
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// VR operators of `algebra::kLanes` cells at a time, interleaved so that the
+// sweep and the update of `b_vector` run on all cells of a block at once.
+// No two cells of a block are neighbors: the relaxation factor of the in-place
+// sweep would make a Jacobi update of two neighbors diverge.
+template <class Mesh>
+class VrBatch {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using Scalar = mesh::Scalar;
+  static constexpr int kLanes = algebra::kLanes;
+  static constexpr int nCoef = CellType::CountCoef();
+  static constexpr int nVar = CellType::CountVariables();
+  template <int kRows, int kCols>
+  using Pack = algebra::Pack<Scalar, kRows, kCols>;
+  struct Block {
+    Pack<nCoef, nCoef> a_matrix_inv;
+    std::array<Pack<nCoef, nCoef>, 3> b_matrices;
+    Pack<nCoef, 3> b_vector_mat;
+    Pack<nCoef, nVar> b_vector;
+    std::array<CellType*, kLanes> cells;
+    std::array<std::array<CellType*, kLanes>, 3> neighbors;
+    int size;
+  };
+
+ public:
+  // Invert the VR matrices of `cells`, and their leading blocks.
+  static void InitializeAmatInv(std::vector<CellType*> const& cells) {
+    int n_blocks = (cells.size() + kLanes - 1) / kLanes;
+    #pragma omp parallel for
+    for (int b = 0; b < n_blocks; ++b) {
+      Pack<nCoef, nCoef> a_matrix;
+      a_matrix.SetIdentity();
+      int size = std::min<int>(kLanes, cells.size() - b * kLanes);
+      for (int l = 0; l < size; ++l) {
+        a_matrix.Load(l, cells[b * kLanes + l]->BuildAmat());
+      }
+      InvertLeadingBlocks(a_matrix, &cells[b * kLanes], size);
+    }
+  }
+  // Pack the operators of `cells`. `get_bmat(cell, edge, i)` is the `b_matrix`
+  // of `edge`, the `i`-th one of `cell`, with the rows belonging to `cell`.
+  template <class GetAmatInv, class GetBvecMat, class GetBmat>
+  void Build(std::vector<CellType*> const& cells, GetAmatInv&& get_amat_inv,
+             GetBvecMat&& get_bvec_mat, GetBmat&& get_bmat) {
+    // Lane `l` of block `b` holds cell `b + l * stride`, so that each lane
+    // sweeps its own strip of cells in order. The few cells neighboring
+    // another one of their block are left to blocks of their own, swept last.
+    int stride = (cells.size() + kLanes - 1) / kLanes;
+    auto groups = std::vector<std::vector<CellType*>>(stride);
+    auto rest = std::vector<CellType*>();
+    for (int b = 0; b < stride; ++b) {
+      for (int i = b; i < cells.size(); i += stride) {
+        bool coupled = false;
+        cells[i]->ForEachEdge([&](EdgeType& edge) {
+          auto* that = edge.GetOpposite(cells[i]);
+          coupled |= std::count(groups[b].begin(), groups[b].end(), that) > 0;
+        });
+        (coupled ? rest : groups[b]).emplace_back(cells[i]);
+      }
+    }
+    n_strips_ = stride;
+    for (auto* cell : rest) { groups.emplace_back(1, cell); }
+    blocks_.resize(groups.size());
+    #pragma omp parallel for
+    for (int b = 0; b < blocks_.size(); ++b) {
+      auto& block = blocks_[b];
+      auto& group = groups[b];
+      block.size = group.size();
+      block.a_matrix_inv.SetZero();
+      block.b_vector_mat.SetZero();
+      block.b_vector.SetZero();
+      for (auto& b_matrix : block.b_matrices) { b_matrix.SetZero(); }
+      for (int l = 0; l < kLanes; ++l) {
+        // Padding lanes repeat the first cell, but are never written back.
+        auto* cell = group[l < block.size ? l : 0];
+        block.cells[l] = cell;
+        int i = 0;
+        cell->ForEachEdge([&](EdgeType& edge) {
+          // A boundary edge has no neighbor, and a zero `b_matrix` for it:
+          auto* that = edge.GetOpposite(cell);
+          block.neighbors[i][l] = that ? that : cell;
+          if (l < block.size) {
+            block.b_matrices[i].Load(l, get_bmat(*cell, edge, i));
+          }
+          ++i;
+        });
+        if (l < block.size) {
+          block.a_matrix_inv.Load(l, get_amat_inv(*cell));
+          block.b_vector_mat.Load(l, get_bvec_mat(*cell));
+        }
+      }
+    }
+  }
+  // Invert the packed `a_matrix_inv` in place, for a `Build` given the VR
+  // matrices themselves, so that no cell has to keep their inverses:
+  void InvertAmat() {
+    #pragma omp parallel for
+    for (int b = 0; b < blocks_.size(); ++b) {
+      auto& block = blocks_[b];
+      Pack<nCoef, nCoef> a_matrix = block.a_matrix_inv;
+      for (int l = block.size; l < kLanes; ++l) {
+        a_matrix.Load(l, Eigen::Matrix<Scalar, nCoef, nCoef>::Identity());
+      }
+      algebra::Invert<nCoef>(a_matrix, &block.a_matrix_inv);
+    }
+  }
+  void Clear() {
+    blocks_.clear();
+    n_strips_ = 0;
+  }
+  bool Empty() const { return blocks_.empty(); }
+  // Forget the `b_vector` of each block, from which the next one predicts:
+  void ClearBvector() {
+    for (auto& block : blocks_) { block.b_vector.SetZero(); }
+  }
+  // Set `b_vector` from `get_jumps(cell)`, the jumps of the cell averages to
+  // the neighbors of `cell`, one row per edge. If `predict`, move the
+  // coefficients by the inverse applied to the increment of `b_vector`.
+  template <class GetJumps>
+  void UpdateBvector(GetJumps&& get_jumps, bool predict) {
+    #pragma omp parallel for
+    for (int b = 0; b < blocks_.size(); ++b) {
+      auto& block = blocks_[b];
+      Pack<3, nVar> jumps;
+      for (int l = 0; l < kLanes; ++l) {
+        jumps.Load(l, get_jumps(*block.cells[l]));
+      }
+      Pack<nCoef, nVar> b_vector;
+      algebra::Multiply(block.b_vector_mat, jumps, &b_vector);
+      if (predict) {
+        Pack<nCoef, nVar> increment;
+        for (int i = 0; i < nCoef; ++i) {
+          for (int j = 0; j < nVar; ++j) {
+            #pragma omp simd
+            for (int l = 0; l < kLanes; ++l) {
+              increment.data[i][j][l] = b_vector.data[i][j][l] -
+                                        block.b_vector.data[i][j][l];
+            }
+          }
+        }
+        Pack<nCoef, nVar> coefficients;
+        LoadCoefficients(block.cells, &coefficients);
+        algebra::MultiplyAdd(block.a_matrix_inv, increment, &coefficients);
+        StoreCoefficients(coefficients, &block);
+      }
+      block.b_vector = b_vector;
+      for (int l = 0; l < block.size; ++l) {
+        b_vector.Store(l, &block.cells[l]->b_vector);
+      }
+    }
+  }
+  // One relaxed sweep, in place like the per-cell one.
+  void Sweep() {
+    #pragma omp parallel for
+    for (int b = 0; b < n_strips_; ++b) { SweepBlock(&blocks_[b]); }
+    for (int b = n_strips_; b < blocks_.size(); ++b) { SweepBlock(&blocks_[b]); }
+  }
+
+ private:
+  static void SweepBlock(Block* block) {
+    Pack<nCoef, nVar> temp = block->b_vector;
+    for (int i = 0; i < 3; ++i) {
+      Pack<nCoef, nVar> neighbors;
+      LoadCoefficients(block->neighbors[i], &neighbors);
+      algebra::MultiplyAdd(block->b_matrices[i], neighbors, &temp);
+    }
+    Pack<nCoef, nVar> coefficients;
+    LoadCoefficients(block->cells, &coefficients);
+    Pack<nCoef, nVar> solution;
+    algebra::Multiply(block->a_matrix_inv, temp, &solution);
+    for (int i = 0; i < nCoef; ++i) {
+      for (int j = 0; j < nVar; ++j) {
+        #pragma omp simd
+        for (int l = 0; l < kLanes; ++l) {
+          coefficients.data[i][j][l] = coefficients.data[i][j][l] * -0.3f +
+                                       solution.data[i][j][l] * 1.3f;
+        }
+      }
+    }
+    StoreCoefficients(coefficients, block);
+  }
+  template <int kP = CellType::Degree()>
+  static void InvertLeadingBlocks(Pack<nCoef, nCoef> const& a_matrix,
+                                  CellType* const* cells, int size) {
+    if constexpr (kP > 0) {
+      constexpr int n = CellType::CountCoef(kP);
+      Pack<n, n> inv;
+      algebra::Invert<n>(a_matrix, &inv);
+      for (int l = 0; l < size; ++l) {
+        auto block = cells[l]->template GetAmatInv<kP>();
+        inv.Store(l, &block);
+      }
+      InvertLeadingBlocks<kP - 1>(a_matrix, cells, size);
+    }
+  }
+  static void LoadCoefficients(std::array<CellType*, kLanes> const& cells,
+                               Pack<nCoef, nVar>* coefficients) {
+    for (int l = 0; l < kLanes; ++l) {
+      coefficients->Load(l, cells[l]->data.coefficients);
+    }
+  }
+  static void StoreCoefficients(Pack<nCoef, nVar> const& coefficients,
+                                Block* block) {
+    for (int l = 0; l < block->size; ++l) {
+      coefficients.Store(l, &block->cells[l]->data.coefficients);
+    }
+  }
+  std::vector<Block> blocks_;
+  int n_strips_{0};
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_BATCH_HPP_
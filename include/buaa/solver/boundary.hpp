@@ -44,6 +44,25 @@ class Manager {
                                       name_to_part_[tail].get());
     SetPeriodicBoundary(name_to_part_[head].get(), name_to_part_[tail].get());
   }
+  // Shift from `edge` to its periodic partner, or zero for other edges.
+  PointType GetPeriodicShift(const EdgeType& edge) const {
+    auto iter = edge_to_shift_.find(&edge);
+    if (iter != edge_to_shift_.end()) { return iter->second; }
+    return PointType(0, 0);
+  }
+  // Distance and shifts of a sewed pair, to be updated after its nodes moved.
+  void UpdatePeriodicGeometry(EdgeType* a, EdgeType* b) {
+    auto owner = [](EdgeType* edge) {
+      auto cell = edge->GetPositiveSide();
+      return cell->Contains(edge) ? cell : edge->GetNegativeSide();
+    };
+    auto dist_ab = PointType(a->Center() - b->Center());
+    dist_ab -= owner(a)->Center() - owner(b)->Center();
+    a->distance = dist_ab.norm();
+    b->distance = dist_ab.norm();
+    edge_to_shift_.at(a) = PointType(b->Center() - a->Center());
+    edge_to_shift_.at(b) = PointType(a->Center() - b->Center());
+  }
   void ClearBoundaryCondition() {
     if (CheckBoundaryConditions()) {
       boundary_edges_.clear();
@@ -68,6 +87,20 @@ class Manager {
       }
     }
   }
+  std::vector<EdgeType*> const& GetInteriorEdges() const {
+    return interior_edges_;
+  }
+  // Interior edges paired with `nullptr`, then periodic pairs:
+  std::vector<std::pair<EdgeType*, EdgeType*>> GetFaces() const {
+    auto faces = std::vector<std::pair<EdgeType*, EdgeType*>>();
+    for (auto* edge : interior_edges_) { faces.emplace_back(edge, nullptr); }
+    for (auto& [left, right] : periodic_part_pairs_) {
+      for (int i = 0; i < left->size(); i++) {
+        faces.emplace_back(left->at(i), right->at(i));
+      }
+    }
+    return faces;
+  }
 
  private:
   // Data members:
@@ -75,6 +108,7 @@ class Manager {
   std::vector<EdgeType*> boundary_edges_;
   std::vector<std::pair<Part*, Part*>> periodic_part_pairs_;
   std::unordered_map<std::string, std::unique_ptr<Part>> name_to_part_;
+  std::unordered_map<const EdgeType*, PointType> edge_to_shift_;
 
   // Implement details:
   void SetPeriodicBoundary(Part* head, Part* tail) {
@@ -99,30 +133,26 @@ class Manager {
     auto a_negative = a->GetNegativeSide();
     auto b_positive = b->GetPositiveSide();
     auto b_negative = b->GetNegativeSide();
-    auto dist_ab = PointType(a->Center() - b->Center());
     if (a_positive == nullptr) {
       if (b_positive == nullptr) {
         a->SetPositiveSide(b_negative);
         b->SetPositiveSide(a_negative);
-        dist_ab -= a_negative->Center() - b_negative->Center();
       } else {
         a->SetPositiveSide(b_positive);
         b->SetNegativeSide(a_negative);
-        dist_ab -= a_negative->Center() - b_positive->Center();
       }
     } else {
       if (b_positive == nullptr) {
         a->SetNegativeSide(b_negative);
         b->SetPositiveSide(a_positive);
-        dist_ab -= a_positive->Center() - b_negative->Center();
       } else {
         a->SetNegativeSide(b_positive);
         b->SetNegativeSide(a_positive);
-        dist_ab -= a_positive->Center() - b_positive->Center();
       }
     }
-    a->distance = dist_ab.norm();
-    b->distance = dist_ab.norm();
+    edge_to_shift_.emplace(a, PointType(0, 0));
+    edge_to_shift_.emplace(b, PointType(0, 0));
+    UpdatePeriodicGeometry(a, b);
   }
   bool CheckBoundaryConditions() {
     int n = 0;
@@ -0,0 +1,164 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_CACHE_HPP_
+#define INCLUDE_BUAA_SOLVER_CACHE_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Binary file of the VR operators of a `Mesh`, keyed by a hash of everything
+// they depend on: the degree, the geometry and the (periodic) pairing of cells.
+template <class Mesh>
+class VrCache {
+  using Scalar = mesh::Scalar;
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using NodeType = typename Mesh::Node;
+
+  struct Header {
+    char magic[8];
+    std::uint64_t key;
+    std::uint64_t n_cells;
+    std::uint64_t n_edges;
+  };
+  static constexpr char kMagic[8] = {'B', 'U', 'A', 'A', 'V', 'R', '0', '1'};
+
+ public:
+  // Constructors:
+  explicit VrCache(std::string const& file_name) : file_name_(file_name) {}
+  // Hash of the inputs of the VR operators, to be called after the periodic
+  // boundaries are sewed and the distances of edges are set:
+  static std::uint64_t GetKey(Mesh const& mesh) {
+    std::uint64_t key = 14695981039346656037ull;  // FNV-1a
+    auto hash = [&](auto const& value) {
+      auto bytes = reinterpret_cast<const unsigned char*>(&value);
+      for (std::size_t i = 0; i != sizeof(value); ++i) {
+        key = (key ^ bytes[i]) * 1099511628211ull;
+      }
+    };
+    hash(CellType::Degree());
+    hash(sizeof(Scalar));
+    mesh.ForEachNode([&](NodeType const& node) {
+      hash(node.X());
+      hash(node.Y());
+    });
+    mesh.ForEachCell([&](CellType& cell) {
+      hash(cell.A().I());
+      hash(cell.B().I());
+      hash(cell.C().I());
+    });
+    mesh.ForEachEdge([&](EdgeType& edge) {
+      auto positive = edge.GetPositiveSide();
+      auto negative = edge.GetNegativeSide();
+      hash(positive ? positive->I() + 1 : 0);
+      hash(negative ? negative->I() + 1 : 0);
+      hash(edge.distance);
+    });
+    return key;
+  }
+  // Map the file and copy the operators into `mesh`, if the file matches it.
+  bool Load(Mesh* mesh) const {
+    int fd = open(file_name_.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size != GetFileSize(*mesh)) {
+      close(fd);
+      return false;
+    }
+    void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) { return false; }
+    auto header = static_cast<const Header*>(addr);
+    bool pass = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                header->key == GetKey(*mesh) &&
+                header->n_cells == mesh->CountCells() &&
+                header->n_edges == mesh->CountEdges();
+    if (pass) {
+      auto data = static_cast<const char*>(addr) + sizeof(Header);
+      auto read = [&](auto* value) {
+        using Value = std::decay_t<decltype(*value)>;
+        if constexpr (std::is_base_of_v<Eigen::MatrixBase<Value>, Value>) {
+          auto scalars = reinterpret_cast<const Scalar*>(data);
+          *value = Eigen::Map<const Value>(scalars);
+        } else {
+          std::memcpy(value, data, sizeof(Value));
+        }
+        data += sizeof(Value);
+      };
+      mesh->ForEachCell([&](CellType& cell) {
+        read(&cell.a_matrix_inv);
+        read(&cell.a_matrix_low_inv);
+        read(&cell.b_vector_mat);
+      });
+      mesh->ForEachEdge([&](EdgeType& edge) {
+        read(&edge.distance);
+        if constexpr (EdgeType::kStoresBmat) { read(&edge.b_matrix); }
+      });
+    }
+    munmap(addr, info.st_size);
+    return pass;
+  }
+  // Write a file of this process, then rename it to `file_name_`, so that any
+  // other process reading the old file keeps it, and no one sees a partial one.
+  bool Save(Mesh const& mesh) const {
+    auto temp_name = file_name_ + ".tmp." + std::to_string(getpid());
+    auto file = std::ofstream(temp_name, std::ios::binary | std::ios::trunc);
+    if (!file) { return false; }
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.key = GetKey(mesh);
+    header.n_cells = mesh.CountCells();
+    header.n_edges = mesh.CountEdges();
+    auto write = [&](auto const& value) {
+      file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    write(header);
+    mesh.ForEachCell([&](CellType& cell) {
+      write(cell.a_matrix_inv);
+      write(cell.a_matrix_low_inv);
+      write(cell.b_vector_mat);
+    });
+    mesh.ForEachEdge([&](EdgeType& edge) {
+      write(edge.distance);
+      if constexpr (EdgeType::kStoresBmat) { write(edge.b_matrix); }
+    });
+    file.close();
+    if (!file || std::rename(temp_name.c_str(), file_name_.c_str()) != 0) {
+      std::remove(temp_name.c_str());
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static off_t GetFileSize(Mesh const& mesh) {
+    auto cell_size = sizeof(CellType::a_matrix_inv) +
+                     sizeof(CellType::a_matrix_low_inv) +
+                     sizeof(CellType::b_vector_mat);
+    auto edge_size = sizeof(EdgeType::distance);
+    if constexpr (EdgeType::kStoresBmat) {
+      edge_size += sizeof(EdgeType::b_matrix);
+    }
+    return sizeof(Header) + cell_size * mesh.CountCells() +
+                            edge_size * mesh.CountEdges();
+  }
+  std::string file_name_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_CACHE_HPP_
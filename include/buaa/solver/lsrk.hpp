@@ -0,0 +1,119 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_LSRK_HPP_
+#define INCLUDE_BUAA_SOLVER_LSRK_HPP_
+
+#include <array>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Stage of a Runge-Kutta scheme on two registers, `u_stages[0]` (u_0) where
+// the residual is evaluated and `u_stages[1]` (u_1) which keeps an earlier
+// state or increment. With f = dt * L(u_0), the stage sets
+//   u_0 = u_0 * to_0[0] + u_1 * to_0[1] + f * to_0[2],
+//   u_1 = u_0 * to_1[0] + u_1 * to_1[1] + f * to_1[2],
+// both from the values before the stage. The first stage never reads u_1.
+struct LowStorageStage {
+  std::array<mesh::Scalar, 3> to_0;
+  std::array<mesh::Scalar, 3> to_1;
+};
+
+// Ketcheson's SSP(s,2): s stages of forward Euler with dt / (s - 1), averaged
+// with u^n at the end. Its SSP coefficient is s - 1.
+template <int kStages>
+struct Ssp2 {
+  static_assert(kStages >= 2);
+  static constexpr int CountStages() { return kStages; }
+  static constexpr mesh::Scalar Cfl() { return kStages - 1; }
+  static constexpr std::array<LowStorageStage, kStages> Stages() {
+    constexpr mesh::Scalar c = 1.0 / (kStages - 1);
+    auto stages = std::array<LowStorageStage, kStages>();
+    for (int i = 0; i < kStages; ++i) {
+      stages[i] = {{1, 0, c}, {0, 1, 0}};
+    }
+    stages[0].to_1 = {1, 0, 0};
+    stages[kStages - 1].to_0 = {(kStages - 1.0) / kStages, 1.0 / kStages,
+                                1.0 / kStages};
+    return stages;
+  }
+};
+
+// Ketcheson's SSP(n^2,3): forward Euler with dt / (n^2 - n), with u_1 saved
+// after stage (n - 1)(n - 2) / 2 and blended back after stage n(n + 1) / 2.
+// Its SSP coefficient is n^2 - n.
+template <int kN>
+struct Ssp3 {
+  static_assert(kN >= 2);
+  static constexpr int CountStages() { return kN * kN; }
+  static constexpr mesh::Scalar Cfl() { return kN * kN - kN; }
+  static constexpr std::array<LowStorageStage, kN * kN> Stages() {
+    constexpr mesh::Scalar c = 1.0 / (kN * kN - kN);
+    auto stages = std::array<LowStorageStage, kN * kN>();
+    for (int i = 0; i < kN * kN; ++i) {
+      stages[i] = {{1, 0, c}, {0, 1, 0}};
+    }
+    // After the `save`-th stage, u_1 is u_0 (u^n if none):
+    constexpr int save = (kN - 1) * (kN - 2) / 2;
+    if (save == 0) {
+      stages[0].to_1 = {1, 0, 0};
+    } else {
+      stages[0].to_1 = {0, 0, 0};
+      stages[save - 1].to_1 = {1, 0, c};
+    }
+    // u_0 = (n * u_1 + (n - 1) * (u_0 + c * f)) / (2n - 1):
+    constexpr int blend = kN * (kN + 1) / 2;
+    constexpr mesh::Scalar w = 1.0 / (2 * kN - 1);
+    stages[blend - 1].to_0 = {(kN - 1) * w, kN * w, (kN - 1) * w * c};
+    return stages;
+  }
+};
+
+// Ketcheson's SSP(10,4), whose SSP coefficient is 6.
+struct Ssp104 {
+  static constexpr int CountStages() { return 10; }
+  static constexpr mesh::Scalar Cfl() { return 6; }
+  static constexpr std::array<LowStorageStage, 10> Stages() {
+    constexpr mesh::Scalar c = 1.0 / 6;
+    auto stages = std::array<LowStorageStage, 10>();
+    for (int i = 0; i < 10; ++i) {
+      stages[i] = {{1, 0, c}, {0, 1, 0}};
+    }
+    stages[0].to_1 = {1, 0, 0};
+    // u_1 = u_1 / 25 + 9 / 25 * (u_0 + c * f), then u_0 = 15 * u_1 - 5 * ...:
+    stages[4].to_0 = {0.4, 0.6, 0.4 * c};
+    stages[4].to_1 = {0.36, 0.04, 0.36 * c};
+    // u^{n+1} = u_1 + 3 / 5 * u_0 + 1 / 10 * f:
+    stages[9].to_0 = {0.6, 1, 0.1};
+    return stages;
+  }
+};
+
+// Williamson's 2N form of a scheme, for schemes given by its A and B:
+// u_1 = A * u_1 + f, u_0 = u_0 + B * u_1.
+template <int kStages>
+constexpr std::array<LowStorageStage, kStages> FromWilliamson(
+    std::array<mesh::Scalar, kStages> const& a,
+    std::array<mesh::Scalar, kStages> const& b) {
+  auto stages = std::array<LowStorageStage, kStages>();
+  for (int i = 0; i < kStages; ++i) {
+    stages[i] = {{1, b[i] * a[i], b[i]}, {0, a[i], 1}};
+  }
+  return stages;
+}
+
+// Williamson's third-order scheme, which is not SSP.
+struct Williamson3 {
+  static constexpr int CountStages() { return 3; }
+  static constexpr mesh::Scalar Cfl() { return 1; }
+  static constexpr std::array<LowStorageStage, 3> Stages() {
+    return FromWilliamson<3>({0.0, -5.0 / 9, -153.0 / 128},
+                             {1.0 / 3, 15.0 / 16, 8.0 / 15});
+  }
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_LSRK_HPP_
@@ -0,0 +1,176 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_LUSGS_HPP_
+#define INCLUDE_BUAA_SOLVER_LUSGS_HPP_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Implicit Euler step of the cell means by LU-SGS (Jameson and Yoon): each
+// face splits its flux Jacobian as (A + r I) / 2 and (A - r I) / 2, where r is
+// `omega` times the largest wave speed `Riemann::GetMaxSpeed` on either side
+// (omega > 1 adds dissipation to the implicit operator), so that
+//   (|cell| / dt + sum r |face| / 2) du + sum (dF(u_j; du_j) - r du_j) |face| / 2
+// = residual
+// is solved by one forward sweep over the lower neighbors and one backward
+// sweep over the upper ones, with dF evaluated matrix-free from the flux of a
+// state. Cells are swept by id, or by blocks of ids colored so that the blocks
+// of a color are swept in parallel.
+template <class Mesh, class Riemann>
+class LuSgs {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using Scalar = mesh::Scalar;
+  using State = std::decay_t<
+      decltype(std::declval<typename CellType::Data&>().u_stages[0])>;
+  using Normal = typename Riemann::Vector;
+
+ public:
+  // Sweep blocks of `block_size` cells of consecutive ids, color by color if
+  // `multicolor`, so that blocks of a color are swept in parallel:
+  void Build(std::vector<CellType*> const& cells, bool multicolor,
+             Scalar omega, int block_size = 64) {
+    Clear();
+    omega_ = omega;
+    int n_blocks = multicolor ? (cells.size() + block_size - 1) / block_size : 1;
+    if (!multicolor) { block_size = cells.size(); }
+    auto block_of = [&](CellType const* cell) {
+      return cell->I() / block_size;
+    };
+    // Greedy coloring, so that no two neighboring blocks share a color:
+    auto colors = std::vector<std::vector<int>>();
+    auto color = std::vector<int>(n_blocks, -1);
+    for (int b = 0; b < n_blocks; ++b) {
+      auto used = std::vector<bool>(colors.size() + 1);
+      for (int i = b * block_size; i < cells.size() && i < (b + 1) * block_size;
+           ++i) {
+        cells[i]->ForEachEdge([&](EdgeType& edge) {
+          auto* that = edge.GetOpposite(cells[i]);
+          int c = that ? color[block_of(that)] : -1;
+          if (c >= 0 && block_of(that) != b) { used[c] = true; }
+        });
+      }
+      int c = std::find(used.begin(), used.end(), false) - used.begin();
+      if (c == colors.size()) { colors.emplace_back(); }
+      colors[c].emplace_back(b);
+      color[b] = c;
+    }
+    rank_.resize(cells.size());
+    for (auto& blocks : colors) {
+      for (int b : blocks) {
+        for (int i = b * block_size;
+             i < cells.size() && i < (b + 1) * block_size; ++i) {
+          rank_[cells[i]->I()] = order_.size();
+          order_.emplace_back(cells[i]);
+        }
+        block_offsets_.emplace_back(order_.size());
+      }
+      color_offsets_.emplace_back(block_offsets_.size() - 1);
+    }
+    delta_.resize(cells.size());
+    diagonal_.resize(cells.size());
+  }
+  void Clear() {
+    order_.clear();
+    block_offsets_ = {0};
+    color_offsets_ = {0};
+    rank_.clear();
+  }
+  bool Empty() const { return order_.empty(); }
+  auto CountColors() const { return color_offsets_.size() - 1; }
+  // Add to `get_state(cell)` the increment solving the system above, with
+  // `get_residual(cell)` the sum of fluxes into `cell` and `get_step_size(cell)`
+  // its dt.
+  template <class GetState, class GetResidual, class GetStepSize>
+  void Step(GetState&& get_state, GetResidual&& get_residual,
+            GetStepSize&& get_step_size) {
+    // Sum of the off-diagonal terms of `cell` on the side given by `lower`,
+    // and the diagonal if asked:
+    auto get_off_diagonal = [&](CellType& cell, bool lower, Scalar* diagonal) {
+      auto sum = State();
+      cell.ForEachEdge([&](EdgeType& edge) {
+        auto* that = edge.GetOpposite(&cell);
+        // Normal of `edge` out of `cell`:
+        auto out = typename Mesh::Point(edge.Center() - cell.Center());
+        auto a = Normal(edge.GetNormalX(), edge.GetNormalY());
+        if (a(0) * out.X() + a(1) * out.Y() < 0) { a = -a; }
+        Scalar half = 0.5 * edge.Measure();
+        // A boundary edge only adds to the diagonal, by the speed of `cell`:
+        if (!that) {
+          if (diagonal) {
+            *diagonal += omega_ * Riemann::GetMaxSpeed(get_state(cell), a) *
+                         half;
+          }
+          return;
+        }
+        auto const& u_that = get_state(*that);
+        Scalar r = omega_ * std::max(Riemann::GetMaxSpeed(get_state(cell), a),
+                            Riemann::GetMaxSpeed(u_that, a));
+        if (diagonal) { *diagonal += r * half; }
+        if (lower ? rank_[that->I()] < rank_[cell.I()]
+                  : rank_[that->I()] > rank_[cell.I()]) {
+          auto const& du = delta_[that->I()];
+          sum = sum + (Riemann::GetFlux(State(u_that + du), a) -
+                       Riemann::GetFlux(u_that, a) - du * r) * half;
+        }
+      });
+      return sum;
+    };
+    auto forward = [&](CellType& cell) {
+      auto& diagonal = diagonal_[cell.I()];
+      diagonal = cell.Measure() / get_step_size(cell);
+      auto sum = get_off_diagonal(cell, true, &diagonal);
+      delta_[cell.I()] = State((get_residual(cell) - sum) / diagonal);
+    };
+    auto backward = [&](CellType& cell) {
+      auto sum = get_off_diagonal(cell, false, nullptr);
+      delta_[cell.I()] = delta_[cell.I()] - sum / diagonal_[cell.I()];
+    };
+    for (int c = 0; c + 1 < color_offsets_.size(); ++c) {
+      ForEachOfColor(c, forward, false);
+    }
+    for (int c = color_offsets_.size() - 2; c >= 0; --c) {
+      ForEachOfColor(c, backward, true);
+    }
+    #pragma omp parallel for
+    for (int i = 0; i < order_.size(); ++i) {
+      auto& cell = *order_[i];
+      get_state(cell) = get_state(cell) + delta_[cell.I()];
+    }
+  }
+
+ private:
+  template <class Visitor>
+  void ForEachOfColor(int c, Visitor&& visit, bool reversed) {
+    #pragma omp parallel for
+    for (int b = color_offsets_[c]; b < color_offsets_[c + 1]; ++b) {
+      int begin = block_offsets_[b], end = block_offsets_[b + 1];
+      if (reversed) {
+        for (int i = end - 1; i >= begin; --i) { visit(*order_[i]); }
+      } else {
+        for (int i = begin; i < end; ++i) { visit(*order_[i]); }
+      }
+    }
+  }
+  // Blocks `color_offsets_[c]` to `color_offsets_[c + 1]` have color `c`, and
+  // block `b` is `order_[block_offsets_[b]]` to `order_[block_offsets_[b + 1]]`:
+  std::vector<CellType*> order_;
+  std::vector<int> block_offsets_{0};
+  std::vector<int> color_offsets_{0};
+  // Cells of lower rank are swept first:
+  std::vector<int> rank_;
+  Scalar omega_{1};
+  std::vector<State> delta_;
+  std::vector<Scalar> diagonal_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_LUSGS_HPP_
@@ -0,0 +1,249 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_MULTIGRID_HPP_
+#define INCLUDE_BUAA_SOLVER_MULTIGRID_HPP_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Full approximation storage (FAS) multigrid on agglomerated cells: each level
+// merges every cell of the one below with its free neighbors, and carries the
+// cell means only. The flux through a coarse face is the first-order flux
+// summed over the fine edges it is made of, so the coarse operator is exactly
+// conservative without building any coarse geometry.
+// A cycle restricts the state (by volume averaging) and the residual (by
+// summation) to a level, smooths it there by SSP-RK3 with local step sizes
+// under the forcing that makes its residual match the restricted one, goes on
+// to the next level, then adds the change of each coarse mean to the means of
+// its cells.
+template <class Mesh, class Riemann>
+class Multigrid {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using Scalar = mesh::Scalar;
+  using State = std::decay_t<
+      decltype(std::declval<typename CellType::Data&>().u_stages[0])>;
+  using Normal = typename Riemann::Vector;
+  // A fine edge between two cells of a level:
+  struct Link {
+    EdgeType* edge;
+    int l, r;
+  };
+  struct Level {
+    // Cell of this level each cell of the level below is merged into:
+    std::vector<int> parents;
+    std::vector<Scalar> measures;
+    std::vector<Link> links;
+    std::vector<State> states, forcing, residuals, u_0, u_1;
+  };
+
+ public:
+  // Agglomerate `cells`, whose ids run from 0, into `n_levels` coarse levels.
+  // `faces` are the interior edges, or the first edges of periodic pairs.
+  void Build(std::vector<std::pair<EdgeType*, EdgeType*>> const& faces,
+             std::vector<CellType*> const& cells, int n_levels) {
+    Clear();
+    auto links = std::vector<Link>();
+    for (auto& [edge, _] : faces) {
+      links.emplace_back(Link{edge,
+                              static_cast<int>(edge->GetPositiveSide()->I()),
+                              static_cast<int>(edge->GetNegativeSide()->I())});
+    }
+    fine_measures_.resize(cells.size());
+    for (auto* cell : cells) { fine_measures_[cell->I()] = cell->Measure(); }
+    auto* measures = &fine_measures_;
+    levels_.reserve(n_levels);
+    for (int k = 0; k < n_levels && measures->size() > 1; ++k) {
+      auto level = Level();
+      Agglomerate(*measures, links, &level);
+      int n = level.measures.size();
+      // Stop once no cell has a free neighbor left:
+      if (n == measures->size()) { break; }
+      level.states.resize(n);
+      level.forcing.resize(n);
+      level.residuals.resize(n);
+      level.u_0.resize(n);
+      level.u_1.resize(n);
+      links = level.links;
+      levels_.emplace_back(std::move(level));
+      measures = &levels_.back().measures;
+    }
+  }
+  void Clear() { levels_.clear(); }
+  bool Empty() const { return levels_.empty(); }
+  auto CountLevels() const { return levels_.size(); }
+  auto CountCells(int level) const { return levels_[level].measures.size(); }
+  // Correct `get_state(cell)` of `cells` (as given to `Build`), given
+  // `get_residual(cell)`, the sum of fluxes into `cell` at that state, with
+  // `n_steps` steps of SSP-RK3 at the local `cfl` on each level.
+  template <class GetState, class GetResidual>
+  void Cycle(std::vector<CellType*> const& cells, GetState&& get_state,
+             GetResidual&& get_residual, int n_steps, Scalar cfl) {
+    if (levels_.empty()) { return; }
+    auto& first = levels_[0];
+    Restrict(&first, fine_measures_, [&](int i) -> State const& {
+      return get_state(*cells[i]);
+    }, [&](int i) {
+      return State(get_residual(*cells[i]));
+    });
+    Correct(0, n_steps, cfl);
+    #pragma omp parallel for
+    for (int i = 0; i < cells.size(); ++i) {
+      int c = first.parents[i];
+      auto& u = get_state(*cells[i]);
+      u = u + (first.states[c] - first.u_0[c]);
+    }
+  }
+
+ private:
+  // Merge each free cell with its free neighbors, and a cell left alone with
+  // the cell of a neighbor.
+  static void Agglomerate(std::vector<Scalar> const& measures,
+                          std::vector<Link> const& links, Level* level) {
+    int n = measures.size();
+    auto neighbors = std::vector<std::vector<int>>(n);
+    for (auto& link : links) {
+      neighbors[link.l].emplace_back(link.r);
+      neighbors[link.r].emplace_back(link.l);
+    }
+    auto& parents = level->parents;
+    parents.assign(n, -1);
+    int n_coarse = 0;
+    for (int i = 0; i < n; ++i) {
+      if (parents[i] >= 0) { continue; }
+      int size = 1;
+      for (int j : neighbors[i]) {
+        if (parents[j] < 0 && j != i) {
+          parents[j] = n_coarse;
+          ++size;
+        }
+      }
+      if (size == 1 && !neighbors[i].empty() &&
+          parents[neighbors[i].front()] >= 0) {
+        parents[i] = parents[neighbors[i].front()];
+      } else {
+        parents[i] = n_coarse++;
+      }
+    }
+    level->measures.assign(n_coarse, 0);
+    for (int i = 0; i < n; ++i) { level->measures[parents[i]] += measures[i]; }
+    level->links.clear();
+    for (auto& link : links) {
+      int l = parents[link.l], r = parents[link.r];
+      if (l != r) { level->links.emplace_back(Link{link.edge, l, r}); }
+    }
+  }
+  // Set the states of `level` and its forcing, from the states and residuals
+  // of the level below, whose cells have `measures`.
+  template <class GetState, class GetResidual>
+  static void Restrict(Level* level, std::vector<Scalar> const& measures,
+                       GetState&& get_state, GetResidual&& get_residual) {
+    int n = measures.size();
+    auto& states = level->states;
+    auto& forcing = level->forcing;
+    std::fill(states.begin(), states.end(), State(0));
+    std::fill(forcing.begin(), forcing.end(), State(0));
+    for (int i = 0; i < n; ++i) {
+      int c = level->parents[i];
+      states[c] = states[c] + get_state(i) * (measures[i] / level->measures[c]);
+      forcing[c] = forcing[c] + get_residual(i);
+    }
+    GetFirstOrderResidual(*level, &level->residuals);
+    #pragma omp parallel for
+    for (int c = 0; c < states.size(); ++c) {
+      forcing[c] = forcing[c] - level->residuals[c];
+    }
+    level->u_0 = states;
+  }
+  // Smooth level `k`, correct it by the levels above, and leave the result in
+  // its states.
+  void Correct(int k, int n_steps, Scalar cfl) {
+    auto& level = levels_[k];
+    for (int step = 0; step < n_steps; ++step) { Smooth(&level, cfl); }
+    if (k + 1 < levels_.size()) {
+      auto& next = levels_[k + 1];
+      GetForcedResidual(level, &level.residuals);
+      Restrict(&next, level.measures, [&](int i) -> State const& {
+        return level.states[i];
+      }, [&](int i) -> State const& {
+        return level.residuals[i];
+      });
+      Correct(k + 1, n_steps, cfl);
+      #pragma omp parallel for
+      for (int i = 0; i < level.states.size(); ++i) {
+        int c = next.parents[i];
+        level.states[i] = level.states[i] + (next.states[c] - next.u_0[c]);
+      }
+    }
+  }
+  // One step of SSP-RK3 on `level`, with the step size of each cell set by
+  // `cfl` and the wave speeds at the start of the step.
+  void Smooth(Level* level, Scalar cfl) {
+    auto& u = level->states;
+    auto& r = level->residuals;
+    int n = u.size();
+    auto rates = std::vector<Scalar>(n);
+    for (auto& link : level->links) {
+      auto a = GetNormal(*link.edge);
+      Scalar speed = std::max(Riemann::GetMaxSpeed(u[link.l], a),
+                              Riemann::GetMaxSpeed(u[link.r], a)) *
+                     link.edge->Measure();
+      rates[link.l] += speed;
+      rates[link.r] += speed;
+    }
+    auto step = [&](int c) {
+      return rates[c] > 0 ? cfl / rates[c] : 0;
+    };
+    level->u_1 = u;
+    GetForcedResidual(*level, &r);
+    #pragma omp parallel for
+    for (int c = 0; c < n; ++c) { u[c] = u[c] + r[c] * step(c); }
+    GetForcedResidual(*level, &r);
+    #pragma omp parallel for
+    for (int c = 0; c < n; ++c) {
+      u[c] = level->u_1[c] * 0.75 + (u[c] + r[c] * step(c)) * 0.25;
+    }
+    GetForcedResidual(*level, &r);
+    #pragma omp parallel for
+    for (int c = 0; c < n; ++c) {
+      u[c] = level->u_1[c] * (1.0 / 3) +
+             (u[c] + r[c] * step(c)) * (2.0 / 3);
+    }
+  }
+  // Sum of first-order fluxes into each cell of `level`:
+  static void GetFirstOrderResidual(Level const& level,
+                                    std::vector<State>* residuals) {
+    auto& u = level.states;
+    std::fill(residuals->begin(), residuals->end(), State(0));
+    for (auto& link : level.links) {
+      auto flux = State(Riemann::GetFlux(u[link.l], u[link.r],
+                                         GetNormal(*link.edge)) *
+                        link.edge->Measure());
+      (*residuals)[link.l] = (*residuals)[link.l] - flux;
+      (*residuals)[link.r] = (*residuals)[link.r] + flux;
+    }
+  }
+  static void GetForcedResidual(Level const& level,
+                                std::vector<State>* residuals) {
+    GetFirstOrderResidual(level, residuals);
+    for (int c = 0; c < residuals->size(); ++c) {
+      (*residuals)[c] = (*residuals)[c] + level.forcing[c];
+    }
+  }
+  static Normal GetNormal(EdgeType const& edge) {
+    return Normal(edge.GetNormalX(), edge.GetNormalY());
+  }
+  std::vector<Level> levels_;
+  std::vector<Scalar> fine_measures_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_MULTIGRID_HPP_
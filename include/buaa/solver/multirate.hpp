@@ -0,0 +1,100 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_MULTIRATE_HPP_
+#define INCLUDE_BUAA_SOLVER_MULTIRATE_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Cells binned into levels of step size dt / 2^l, with what a level needs to
+// be stepped on its own: its faces, the faces it shares with finer levels,
+// and the halo of cells of other levels within two edges of it, whose values
+// its reconstruction and fluxes read.
+template <class Mesh>
+class MultirateLevels {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using Face = std::pair<EdgeType*, EdgeType*>;
+
+ public:
+  // Bin `cells`, whose ids run from 0, by `levels` (indexed by id). `faces`
+  // are the interior edges, or pairs of periodic ones.
+  void Build(std::vector<Face> const& faces,
+             std::vector<CellType*> const& cells,
+             std::vector<int> const& levels) {
+    faces_ = faces;
+    levels_ = levels;
+    int n_levels = 1 + *std::max_element(levels.begin(), levels.end());
+    cells_.assign(n_levels, {});
+    level_faces_.assign(n_levels, {});
+    interfaces_.assign(n_levels, {});
+    halos_.assign(n_levels, {});
+    n_neighbors_.assign(n_levels, 0);
+    for (auto* cell : cells) { cells_[levels[cell->I()]].emplace_back(cell); }
+    for (int f = 0; f < faces.size(); ++f) {
+      int l = GetLevel(*faces[f].first->GetPositiveSide());
+      int r = GetLevel(*faces[f].first->GetNegativeSide());
+      level_faces_[l].emplace_back(f);
+      if (r != l) {
+        level_faces_[r].emplace_back(f);
+        interfaces_[std::min(l, r)].emplace_back(f);
+      }
+    }
+    // Mark each cell by the last level whose halo it was added to:
+    auto marks = std::vector<int>(cells.size(), -1);
+    for (int l = 0; l < n_levels; ++l) {
+      auto& halo = halos_[l];
+      auto add_neighbors = [&](CellType* cell) {
+        cell->ForEachEdge([&](EdgeType& edge) {
+          auto* that = edge.GetOpposite(cell);
+          if (that && levels_[that->I()] != l && marks[that->I()] != l) {
+            marks[that->I()] = l;
+            halo.emplace_back(that);
+          }
+        });
+      };
+      for (auto* cell : cells_[l]) { add_neighbors(cell); }
+      n_neighbors_[l] = halo.size();
+      for (int i = 0; i < n_neighbors_[l]; ++i) { add_neighbors(halo[i]); }
+    }
+  }
+  void Clear() {
+    faces_.clear();
+    levels_.clear();
+    cells_.clear();
+  }
+  bool Empty() const { return cells_.empty(); }
+  int CountLevels() const { return cells_.size(); }
+  int GetLevel(CellType const& cell) const { return levels_[cell.I()]; }
+  // Levels of the cells binned, by id:
+  std::vector<int> const& GetLevels() const { return levels_; }
+  Face const& GetFace(int f) const { return faces_[f]; }
+  std::vector<CellType*> const& GetCells(int l) const { return cells_[l]; }
+  // Faces with a side at level `l`:
+  std::vector<int> const& GetFaces(int l) const { return level_faces_[l]; }
+  // Faces between level `l` and a finer level:
+  std::vector<int> const& GetInterfaces(int l) const { return interfaces_[l]; }
+  // Cells of other levels within two edges of level `l`, the first
+  // `CountNeighbors(l)` of which are next to it:
+  std::vector<CellType*> const& GetHalo(int l) const { return halos_[l]; }
+  int CountNeighbors(int l) const { return n_neighbors_[l]; }
+
+ private:
+  std::vector<Face> faces_;
+  std::vector<int> levels_;
+  std::vector<std::vector<CellType*>> cells_;
+  std::vector<std::vector<int>> level_faces_;
+  std::vector<std::vector<int>> interfaces_;
+  std::vector<std::vector<CellType*>> halos_;
+  std::vector<int> n_neighbors_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_MULTIRATE_HPP_
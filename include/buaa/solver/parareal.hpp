@@ -0,0 +1,91 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_PARAREAL_HPP_
+#define INCLUDE_BUAA_SOLVER_PARAREAL_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/solver/variables.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Parareal (Lions, Maday and Turinici) over time slices, for the cell means
+// of `Rkvr`s: with a cheap coarse propagator G and an accurate fine one F,
+//   U[n + 1] = G(U'[n]) + F(U[n]) - G(U[n]),
+// where U are the values at the ends of the slices of the last iteration and
+// U' those of this one. The fine propagations of an iteration are
+// independent, so run concurrently, while the coarse ones run in order.
+// After k iterations the first k slices are exact, so F is only run from
+// there on.
+template <class State>
+class Parareal {
+  using Scalar = mesh::Scalar;
+  using Value = std::vector<State>;
+
+ public:
+  // Iterate from `u_0` over `n_slices` slices until the values change by at
+  // most `tolerance` times the largest of `u_0`, or for `max_iterations`.
+  // `coarse(n, u, &v)` and `fine(n, u, &v)` set `v` to the value propagated
+  // from `u` over slice `n`; `fine` is called concurrently for different
+  // slices, so each thread needs a propagator of its own.
+  // Return the number of iterations.
+  template <class Coarse, class Fine>
+  int Solve(Value const& u_0, int n_slices, Coarse&& coarse, Fine&& fine,
+            int max_iterations, Scalar tolerance) {
+    values_.assign(n_slices + 1, u_0);
+    coarse_.resize(n_slices);
+    fine_.resize(n_slices);
+    changes_.clear();
+    for (int n = 0; n < n_slices; ++n) {
+      coarse(n, values_[n], &coarse_[n]);
+      values_[n + 1] = coarse_[n];
+    }
+    Scalar scale = GetMaxNorm(u_0);
+    auto next = Value();
+    for (int k = 1; k <= std::min(max_iterations, n_slices); ++k) {
+      #pragma omp parallel for schedule(dynamic)
+      for (int n = k - 1; n < n_slices; ++n) {
+        fine(n, values_[n], &fine_[n]);
+      }
+      Scalar change = 0;
+      for (int n = k - 1; n < n_slices; ++n) {
+        coarse(n, values_[n], &next);
+        auto& value = values_[n + 1];
+        for (int i = 0; i < value.size(); ++i) {
+          State updated = next[i] + (fine_[n][i] - coarse_[n][i]);
+          // Not `std::max`, which would drop a NaN:
+          Scalar norm = GetMaxNorm(updated - value[i]);
+          if (!(norm <= change)) { change = norm; }
+          value[i] = updated;
+        }
+        std::swap(coarse_[n], next);
+      }
+      changes_.emplace_back(change);
+      if (change <= tolerance * scale) { return k; }
+    }
+    return changes_.size();
+  }
+  // The value at the end of slice `n - 1`, or `u_0` if `n` is 0:
+  Value const& GetValue(int n) const { return values_[n]; }
+  // The largest change of the values in each iteration:
+  std::vector<Scalar> const& GetChanges() const { return changes_; }
+
+ private:
+  static Scalar GetMaxNorm(State const& state) {
+    return Variables<State>::ToRow(state).cwiseAbs().maxCoeff();
+  }
+  static Scalar GetMaxNorm(Value const& value) {
+    Scalar norm = 0;
+    for (auto& state : value) { norm = std::max(norm, GetMaxNorm(state)); }
+    return norm;
+  }
+  std::vector<Value> values_, coarse_, fine_;
+  std::vector<Scalar> changes_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_PARAREAL_HPP_
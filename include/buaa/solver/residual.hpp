@@ -0,0 +1,47 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_RESIDUAL_HPP_
+#define INCLUDE_BUAA_SOLVER_RESIDUAL_HPP_
+
+#include <algorithm>
+#include <cmath>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Norms of a residual r over the cells, all of its variables together:
+// l1 = sum |cell| * |r| / sum |cell|, l2 alike with r^2, linf = max |r|.
+struct ResidualNorms {
+  mesh::Scalar l1{0};
+  mesh::Scalar l2{0};
+  mesh::Scalar linf{0};
+};
+
+// Norms of `get_residual(cell)`, a row of the time derivative of the means.
+template <class Mesh, class GetResidual>
+ResidualNorms GetResidualNorms(Mesh const& mesh, GetResidual&& get_residual) {
+  using CellType = typename Mesh::Cell;
+  struct Sums {
+    double measure, l1, l2, linf;
+  };
+  auto sums = mesh.ReduceCellsParallel(Sums{0, 0, 0, 0}, [&](CellType& cell) {
+    auto r = get_residual(cell);
+    double measure = cell.Measure();
+    return Sums{measure, measure * r.cwiseAbs().sum(),
+                measure * r.squaredNorm(), r.cwiseAbs().maxCoeff()};
+  }, [](Sums const& a, Sums const& b) {
+    return Sums{a.measure + b.measure, a.l1 + b.l1, a.l2 + b.l2,
+                std::max(a.linf, b.linf)};
+  });
+  auto norms = ResidualNorms();
+  norms.l1 = sums.l1 / sums.measure;
+  norms.l2 = std::sqrt(sums.l2 / sums.measure);
+  norms.linf = sums.linf;
+  return norms;
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_RESIDUAL_HPP_
@@ -2,18 +2,37 @@
 #ifndef INCLUDE_BUAA_SOLVER_RKVR_HPP_
 #define INCLUDE_BUAA_SOLVER_RKVR_HPP_
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
+#include <limits>
 #include <memory>
 #include <omp.h>
 #include <set>
+#include <stdexcept>
 #include <stdio.h>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "buaa/mesh/dim2.hpp"
 #include "buaa/mesh/vtk/reader.hpp"
 #include "buaa/mesh/vtk/writer.hpp"
+#include "buaa/solver/batch.hpp"
 #include "buaa/solver/boundary.hpp"
+#include "buaa/solver/cache.hpp"
+#include "buaa/solver/lsrk.hpp"
+#include "buaa/solver/lusgs.hpp"
+#include "buaa/solver/multigrid.hpp"
+#include "buaa/solver/multirate.hpp"
+#include "buaa/solver/residual.hpp"
+#include "buaa/solver/shared.hpp"
+#include "buaa/solver/smoothing.hpp"
+#include "buaa/solver/tableau.hpp"
+#include "buaa/solver/variables.hpp"
+#include "buaa/solver/wavefront.hpp"
 
 namespace buaa {
 namespace solver {
@@ -22,14 +41,29 @@ template <class Mesh, class Riemann>
 class Rkvr {
   using PointType = typename Mesh::Point;
   using EdgeType = typename Mesh::Edge;
+  using NodeType = typename Mesh::Node;
   using CellType = typename Mesh::Cell;
   using Vector = typename CellType::Vector;
   using Matrix = typename CellType::Matrix;
-  using State = typename Riemann::State;
-  using FluxType = typename Riemann::Flux;
+  using Coefficients = typename CellType::Coefficients;
+  using State = std::decay_t<decltype(std::declval<typename CellType::Data&>().u_stages[0])>;
+  using Variable = Variables<State>;
+  static constexpr int kSlots =
+      sizeof(std::declval<typename CellType::Data&>().u_stages) / sizeof(State);
+  using FluxType = typename Riemann::FluxType;
+  using Normal = typename Riemann::Vector;
   using Reader = mesh::vtk::Reader<Mesh>;
   using Writer = mesh::vtk::Writer<Mesh>;
-  static constexpr int degree = Mesh::kDegree;
+  static constexpr int degree = CellType::Degree();
+  static constexpr bool kMatrixFree =
+      (EdgeType::kVrStorage == mesh::VrStorage::kMatrixFree);
+  static constexpr bool kShared =
+      (EdgeType::kVrStorage == mesh::VrStorage::kShared);
+  static constexpr bool kBatched =
+      (EdgeType::kVrStorage == mesh::VrStorage::kBatched);
+  enum class Stepping { kFixed, kAdaptive, kLocal };
+  static_assert(Variable::Count() == CellType::CountVariables(),
+                "`coefficients` needs one column per variable of `u_stages`.");
 
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -53,11 +87,158 @@ class Rkvr {
     duration_ = duration;
     n_steps_ = n_steps;
     step_size_ = duration / n_steps;
+    stepping_ = Stepping::kFixed;
     refresh_rate_ = refresh_rate;
   }
+  // March to `duration` with the largest step allowed by `cfl` (times the SSP
+  // coefficient `Cfl()` of the scheme), shortened to land exactly on each
+  // multiple of `output_interval`, where frames are written. Both `cfl` and
+  // `output_interval` must be positive, or time would never advance.
+  void SetAdaptiveTimeSteps(Scalar duration, Scalar cfl,
+                            Scalar output_interval) {
+    if (!(cfl > 0) || !(output_interval > 0)) {
+      throw std::invalid_argument("`cfl` and `output_interval` must be "
+                                  "positive.");
+    }
+    duration_ = duration;
+    cfl_ = cfl;
+    output_interval_ = output_interval;
+    stepping_ = Stepping::kAdaptive;
+  }
+  // For steady problems only: run `n_steps` steps, in which each cell
+  // advances with its own largest step allowed by `cfl`.
+  void SetLocalTimeSteps(int n_steps, Scalar cfl, int refresh_rate) {
+    n_steps_ = n_steps;
+    cfl_ = cfl;
+    refresh_rate_ = refresh_rate;
+    stepping_ = Stepping::kLocal;
+  }
+  // March `n_steps` steps of SSP-RK3 to `duration`, in which each cell whose
+  // largest step allowed by `cfl` is below dt takes 2^l steps of dt / 2^l
+  // instead, for the least l < `n_levels` needed (`Calculate` throws if a
+  // cell needs more). Levels are stepped from the coarsest, and the fluxes a
+  // level shares with finer ones are replaced by the ones the finer levels
+  // integrated, so the means are conserved. The cells are binned again only
+  // when their levels change. Levels gather the raw fluxes, so `Calculate`
+  // throws if `SetResidualSmoothing` is on too.
+  void SetMultirateTimeSteps(Scalar duration, int n_steps, int refresh_rate,
+                             Scalar cfl, int n_levels) {
+    static_assert(kSlots >= 2, "`u_stages` has too few slots for multirate.");
+    static_assert(!kBatched, "Multirate levels need per-cell VR sweeps.");
+    SetTimeSteps(duration, n_steps, refresh_rate);
+    cfl_ = cfl;
+    n_rate_levels_ = n_levels;
+    stepper_ = &Rkvr::MultirateStepper;
+    scheme_cfl_ = SspRk33::Cfl();
+  }
+  // Accessors:
+  std::vector<Scalar> const& GetStepSizes() const { return step_sizes_; }
+  // Norms logged by the residual monitor, and the steps they were taken at:
+  std::vector<ResidualNorms> const& GetResiduals() const { return residuals_; }
+  std::vector<int> const& GetResidualSteps() const { return residual_steps_; }
   void SetOutputDir(std::string dir) {
     dir_ = dir;
   }
+  // Reuse the VR operators saved in `file_name` if it matches the mesh,
+  // or save them there after computing them.
+  void SetVrCache(std::string const& file_name) {
+    static_assert(!kBatched, "Batched VR operators are not cached.");
+    cache_file_ = file_name;
+  }
+  // Run the VR sweeps on blocks of `algebra::kLanes` cells with the batched
+  // kernels, while all cells use the full degree. The blocks hold copies of
+  // the operators of the cells and edges; `VrStorage::kBatched` keeps them in
+  // the blocks alone, and always runs so, but has no per-cell sweeps for the
+  // features that need them (adaptive degrees, p-multigrid, tiling, multirate).
+  void SetVrBatching(bool batched) {
+    batched_ = batched;
+  }
+  // Run the update of `b_vector` and the VR sweeps of each stage as a
+  // wavefront over tiles of at least `tile_size` cells (0 to disable), which
+  // should hold about `n_sweeps` tiles of operators in cache:
+  void SetVrTiling(int tile_size) {
+    static_assert(!kBatched, "Batched VR operators are swept by blocks.");
+    tile_size_ = tile_size;
+  }
+  // Run the Riemann solver on the interior edges `kFluxBlock` at a time, at
+  // all their quadrature points at once, through its batched `GetFluxes`:
+  void SetFluxBatching(bool batched) {
+    flux_batched_ = batched;
+  }
+  // Step with the Shu-Osher or Butcher tableau of `Scheme` (`SspRk33` by
+  // default), whose stage values must fit in `u_stages`. Steps set by a CFL
+  // number grow with its `Cfl()`.
+  template <class Scheme>
+  void SetTimeScheme() {
+    static_assert(ShuOsherSteps<Scheme>::CountSlots() <= kSlots,
+                  "`u_stages` has too few slots for the scheme.");
+    stepper_ = &Rkvr::ShuOsherStepper<Scheme>;
+    scheme_cfl_ = Scheme::Cfl();
+  }
+  // Step with a two-register `Scheme` (e.g. `Ssp104`), which only needs
+  // `u_stages[0]` and `u_stages[1]`, as `SetTimeScheme` does:
+  template <class Scheme>
+  void SetLowStorageScheme() {
+    stepper_ = &Rkvr::LowStorageStepper<Scheme>;
+    scheme_cfl_ = Scheme::Cfl();
+  }
+  // For steady problems only: replace each step by an implicit Euler step of
+  // LU-SGS, with cells swept by id or, if `multicolor`, color by color in
+  // parallel. Use it with `SetLocalTimeSteps` and a large CFL number; `omega`
+  // scales the dissipation of the implicit operator, which has to dominate
+  // the high-order residual.
+  void SetLuSgsScheme(bool multicolor, Scalar omega = 1.5) {
+    multicolor_ = multicolor;
+    omega_ = omega;
+    lu_sgs_.Clear();
+    stepper_ = &Rkvr::LuSgsStepper;
+    scheme_cfl_ = 1;
+  }
+  // Follow each step by a cycle of `n_levels` agglomerated levels (0 to
+  // disable), each smoothed by `n_steps` steps of SSP-RK3 at the local `cfl`,
+  // to speed up the convergence of steady problems:
+  void SetMultigrid(int n_levels, int n_steps = 2, Scalar cfl = 1) {
+    n_levels_ = n_levels;
+    n_coarse_steps_ = n_steps;
+    coarse_cfl_ = cfl;
+  }
+  // Follow each step by `n_steps` steps at degree 1 and then at degree 0 (the
+  // plain finite volume scheme) of the same reconstruction, each under the
+  // forcing that makes its residual match the one of the level above, as the
+  // basis is hierarchical (p-multigrid, 0 steps to disable):
+  void SetPMultigrid(int n_steps) {
+    static_assert(!kBatched, "Batched VR operators are of the full degree.");
+    n_p_steps_ = n_steps;
+  }
+  // Step with residuals smoothed implicitly by `n_sweeps` Jacobi sweeps with
+  // coefficient `epsilon` (0 to disable), which allows a larger CFL number
+  // for steady problems:
+  void SetResidualSmoothing(Scalar epsilon, int n_sweeps = 2) {
+    epsilon_ = epsilon;
+    n_smoothing_sweeps_ = n_sweeps;
+  }
+  // Number of VR sweeps per stage, and whether each stage starts from
+  // the coefficients predicted by the increment of `b_vector`.
+  void SetVrIteration(int n_sweeps, bool predict) {
+    n_sweeps_ = n_sweeps;
+    predict_ = predict;
+  }
+  // Let each cell drop to degree 1 where the face jump of its polynomial is
+  // comparable to the jump of the means (`trouble_tol`, a discontinuity), or
+  // where degree 1 already matches its neighbors within `smooth_tol`.
+  void SetAdaptiveDegree(Scalar trouble_tol, Scalar smooth_tol) {
+    static_assert(!kBatched, "Batched VR operators are of the full degree.");
+    adaptive_ = true;
+    trouble_tol_ = trouble_tol;
+    smooth_tol_ = smooth_tol;
+  }
+  // Every `rate` steps, log the norms of the residual of the state a step
+  // starts from, and stop once its L2 norm is below `tolerance` times the
+  // first one (never if `tolerance` is 0).
+  void SetResidualMonitor(int rate, Scalar tolerance) {
+    monitor_rate_ = rate;
+    tolerance_ = tolerance;
+  }
   template <class Visitor>
   void SetBoundaryName(std::string const& name, Visitor&& visitor) {
     edge_manager_.SetBoundaryName(name, visitor);
@@ -68,25 +249,127 @@ class Rkvr {
   }
   // Major computation:
   void Calculate() {
-    edge_manager_.ClearBoundaryCondition();
     writer_ = Writer();
     // Write the frame of initial state:
     auto filename = dir_ + model_name_ + "." + std::to_string(0) + ".vtu";
     bool pass = WriteCurrentFrame(filename);
     assert(pass);
-    InitializeVrMatrix();
-    for (int i = 1; i <= n_steps_ && pass; i++) {
-      // Runge-Kutta three steps :
-      RungeKutta3Stepper();
-      if (i % refresh_rate_ == 0) {
+    if (!prepared_) { Prepare(); }
+    step_sizes_.clear();
+    residuals_.clear();
+    residual_steps_.clear();
+    // Convergence history, one line per residual taken:
+    auto log = std::unique_ptr<std::FILE, int(*)(std::FILE*)>(nullptr,
+                                                             std::fclose);
+    if (monitor_rate_ > 0) {
+      auto log_name = dir_ + model_name_ + ".residual.txt";
+      log.reset(std::fopen(log_name.c_str(), "w"));
+      if (log) { std::fprintf(log.get(), "step l1 l2 linf\n"); }
+    }
+    Scalar time = 0;
+    int n_frames = 1;
+    bool adaptive = (stepping_ == Stepping::kAdaptive);
+    for (int i = 1; pass && (adaptive ? time < duration_ : i <= n_steps_);
+         i++) {
+      bool output;
+      if (adaptive) {
+        auto next_output = std::min(n_frames * output_interval_, duration_);
+        step_size_ = GetStableStepSize();
+        output = (time + step_size_ >= next_output);
+        if (output) {
+          step_size_ = next_output - time;
+          time = next_output;
+          ++n_frames;
+        } else {
+          time += step_size_;
+        }
+        step_sizes_.emplace_back(step_size_);
+      } else {
+        output = (i % refresh_rate_ == 0);
+        if (stepping_ == Stepping::kLocal) {
+          local_step_sizes_.resize(mesh_->CountCells());
+          mesh_->ForEachCellParallel([&](CellType& cell) {
+            local_step_sizes_[cell.I()] = GetLocalStepSize(cell);
+          });
+        }
+      }
+      bool monitored = (monitor_rate_ > 0 && (i - 1) % monitor_rate_ == 0);
+      monitor_step_ = monitored ? i - 1 : -1;
+      (this->*stepper_)();
+      if (n_p_steps_ > 0) { PMultigridCycle(); }
+      if (n_levels_ > 0) { MultigridCycle(); }
+      if (adaptive_) { UpdateDegrees(); }
+      bool converged = false;
+      if (!residual_steps_.empty() && residual_steps_.back() == i - 1) {
+        auto const& norms = residuals_.back();
+        if (log) {
+          std::fprintf(log.get(), "%d %g %g %g\n", i - 1, norms.l1, norms.l2,
+                       norms.linf);
+          std::fflush(log.get());
+        }
+        converged = (tolerance_ > 0 &&
+                     norms.l2 <= tolerance_ * residuals_.front().l2);
+        output |= converged;
+      }
+      if (output) {
         filename = dir_ + model_name_ + "." + std::to_string(i) + ".vtu";
         pass = WriteCurrentFrame(filename);
-        std::printf("Progress: %d/%d\n", i, n_steps_);
+        if (adaptive) {
+          std::printf("Progress: t = %g/%g, step %d, dt = %g\n", time,
+                      duration_, i, step_size_);
+        } else {
+          std::printf("Progress: %d/%d\n", i, n_steps_);
+        }
+        if (!residuals_.empty()) {
+          auto const& norms = residuals_.back();
+          std::printf("Residual: l1 = %g, l2 = %g, linf = %g\n", norms.l1,
+                      norms.l2, norms.linf);
+        }
+      }
+      if (converged) {
+        std::printf("Converged at step %d\n", i);
+        break;
       }
     }
   }
+  // For time-parallel drivers, e.g. `Parareal`: the cell means by id, which
+  // are all the state there is, and `n_steps` steps of `step_size` from them
+  // without output.
+  void GetMeans(std::vector<State>* means) const {
+    means->resize(mesh_->CountCells());
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      (*means)[cell.I()] = cell.data.u_stages[0];
+    });
+  }
+  // The reconstruction, and the `b_vector` it is predicted from, belong to the
+  // means replaced, so are reset as in `Prepare`:
+  void SetMeans(std::vector<State> const& means) {
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      cell.data.u_stages[0] = means[cell.I()];
+      cell.b_vector = Coefficients::Zero();
+      cell.data.Initialize();
+    });
+    batch_.ClearBvector();
+    u_rates_.clear();
+  }
+  void March(Scalar step_size, int n_steps) {
+    if (!prepared_) { Prepare(); }
+    step_size_ = step_size;
+    stepping_ = Stepping::kFixed;
+    for (int i = 0; i < n_steps; ++i) {
+      (this->*stepper_)();
+      if (adaptive_) { UpdateDegrees(); }
+    }
+  }
 //  private:
  public:
+  // Build what the steps need, once boundary conditions are set:
+  void Prepare() {
+    edge_manager_.ClearBoundaryCondition();
+    InitializeVrMatrix();
+    rates_.Clear();
+    prepared_ = true;
+  }
   bool WriteCurrentFrame(std::string const& filename) {
     mesh_->ForEachCellParallel([&](CellType& cell) {
       cell.data.Write();
@@ -106,75 +389,423 @@ class Rkvr {
       }
     });
   }
-  void RungeKutta3Stepper() {
+  // Stage `kI` of `Scheme`, then the following ones. Each stage is one pass
+  // over the cells, with the coefficients known at compile time.
+  template <class Scheme, int kI = 0>
+  void ShuOsherStepper() {
+    using Steps = ShuOsherSteps<Scheme>;
+    constexpr int slot = Steps::kSlots[kI];
+    GetFluxOnEachEdge(slot);
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      auto& u = cell.data.u_stages;
+      State value = u[slot] * Steps::Alpha(kI, kI) +
+          GetRHS(cell) * (Steps::Beta(kI) * GetStepSize(cell) / cell.Measure());
+      AddStageValues<Steps, kI>(u, &value,
+                                std::make_integer_sequence<int, kI>());
+      u[Steps::kSlots[kI + 1]] = value;
+    });
+    if constexpr (kI + 1 < Steps::kStages) {
+      ShuOsherStepper<Scheme, kI + 1>();
+    }
+  }
+  template <class Steps, int kI, class Stages, int... kK>
+  static void AddStageValues(Stages const& u, State* value,
+                             std::integer_sequence<int, kK...>) {
+    auto add = [&](auto k) {
+      constexpr int kSlot = Steps::kSlots[decltype(k)::value];
+      constexpr Scalar kAlpha = Steps::Alpha(kI, decltype(k)::value);
+      if constexpr (kAlpha != 0) { *value = *value + u[kSlot] * kAlpha; }
+    };
+    (add(std::integral_constant<int, kK>()), ...);
+  }
+  template <class Scheme, int kI = 0>
+  void LowStorageStepper() {
+    constexpr auto stage = Scheme::Stages()[kI];
     GetFluxOnEachEdge(0);
     mesh_->ForEachCellParallel([&](CellType& cell) {
-      auto rhs = GetRHS(cell);
-      cell.data.u_stages[1] = cell.data.u_stages[0] +
-                              rhs * step_size_ / cell.Measure();
+      FluxType f = GetRHS(cell) * GetStepSize(cell) / cell.Measure();
+      auto& u = cell.data.u_stages;
+      State u_0 = u[0];
+      auto combine = [&](auto const& c) {
+        State value = u_0 * c[0] + f * c[2];
+        // `u[1]` is not set before the first stage:
+        if (kI > 0 && c[1] != 0) { value = value + u[1] * c[1]; }
+        return value;
+      };
+      u[0] = combine(stage.to_0);
+      u[1] = combine(stage.to_1);
     });
-    GetFluxOnEachEdge(1);
+    if constexpr (kI + 1 < Scheme::CountStages()) {
+      LowStorageStepper<Scheme, kI + 1>();
+    }
+  }
+  void LuSgsStepper() {
+    if (lu_sgs_.Empty()) { lu_sgs_.Build(GetCells(), multicolor_, omega_); }
+    GetFluxOnEachEdge(0);
+    lu_sgs_.Step([](CellType& cell) -> State& {
+      return cell.data.u_stages[0];
+    }, [&](CellType& cell) {
+      return GetRHS(cell);
+    }, [&](CellType& cell) {
+      return GetStepSize(cell);
+    });
+  }
+  void MultigridCycle() {
+    GetFluxOnEachEdge(0);
+    multigrid_.Cycle(GetCells(), [](CellType& cell) -> State& {
+      return cell.data.u_stages[0];
+    }, [&](CellType& cell) {
+      return GetRawRHS(cell);
+    }, n_coarse_steps_, coarse_cfl_);
+  }
+  // Steps at degrees 1 and 0, each forced by the residual of the one above.
+  // All levels share the cell means, so their corrections need no transfer.
+  void PMultigridCycle() {
+    int n = mesh_->CountCells();
+    saved_degrees_.resize(n);
+    saved_coefficients_.resize(n);
+    p_forcing_.assign(n, FluxType(0));
+    GetFluxOnEachEdge(0);
     mesh_->ForEachCellParallel([&](CellType& cell) {
-      auto rhs = GetRHS(cell);
-      cell.data.u_stages[2] = cell.data.u_stages[0] * 0.75 + 
-                             (cell.data.u_stages[1] +
-                              rhs * step_size_ / cell.Measure()) * 0.25;
+      p_forcing_[cell.I()] = GetRawRHS(cell);
+      saved_degrees_[cell.I()] = cell.ActiveDegree();
+      saved_coefficients_[cell.I()] = cell.data.coefficients;
     });
-    GetFluxOnEachEdge(2);
+    for (int p = std::min(degree - 1, 1); p >= 0; --p) {
+      // The residual above is in `p_forcing_`, that of degree `p` is not:
+      coarse_degree_ = p;
+      mesh_->ForEachCellParallel([&](CellType& cell) {
+        cell.SetActiveDegree(std::min(p, saved_degrees_[cell.I()]));
+      });
+      forced_ = false;
+      GetFluxOnEachEdge(0);
+      mesh_->ForEachCellParallel([&](CellType& cell) {
+        p_forcing_[cell.I()] -= GetRawRHS(cell);
+      });
+      forced_ = true;
+      for (int i = 0; i < n_p_steps_; ++i) { (this->*stepper_)(); }
+      if (p > 0) {
+        GetFluxOnEachEdge(0);
+        mesh_->ForEachCellParallel([&](CellType& cell) {
+          p_forcing_[cell.I()] = GetRawRHS(cell);
+        });
+      }
+    }
+    forced_ = false;
+    coarse_degree_ = -1;
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      cell.SetActiveDegree(saved_degrees_[cell.I()]);
+      cell.data.coefficients = saved_coefficients_[cell.I()];
+    });
+  }
+  // Bin the cells by the steps allowed in them, then step from the coarsest.
+  // The steps follow the state, so the levels are found again each step, but
+  // the bins are only rebuilt when they change.
+  void MultirateStepper() {
+    if (epsilon_ > 0) {
+      throw std::invalid_argument("Residual smoothing is not applied to "
+                                  "multirate steps.");
+    }
+    if (monitor_step_ >= 0) {
+      // The levels only update the fluxes of their own cells:
+      GetFluxOnEachEdge(0);
+    }
+    auto n_cells = mesh_->CountCells();
+    rate_levels_.resize(n_cells);
     mesh_->ForEachCellParallel([&](CellType& cell) {
-      auto rhs = GetRHS(cell);
-      cell.data.u_stages[0] = cell.data.u_stages[0] / 3 + 
-                             (cell.data.u_stages[2] +
-                              rhs * step_size_ / cell.Measure()) * 2 / 3;
+      Scalar dt = GetLocalStepSize(cell);
+      int l = 0;
+      while (l < n_rate_levels_ && step_size_ / (1 << l) > dt) { ++l; }
+      rate_levels_[cell.I()] = l;
     });
+    // A cell of level `n_rate_levels_` is unstable even at the finest one:
+    if (*std::max_element(rate_levels_.begin(), rate_levels_.end()) ==
+        n_rate_levels_) {
+      throw std::runtime_error("Some cells need a step below the finest "
+                               "level; add levels or steps.");
+    }
+    if (rates_.Empty() || rates_.GetLevels() != rate_levels_) {
+      auto faces = edge_manager_.GetFaces();
+      rates_.Build(faces, GetCells(), rate_levels_);
+      level_starts_.resize(rates_.CountLevels());
+      reflux_.assign(faces.size(), FluxType(0));
+    }
+    u_old_.resize(n_cells);
+    if (u_rates_.size() != n_cells) {
+      u_rates_.resize(n_cells);
+      GetFluxOnEachEdge(0);
+      mesh_->ForEachCellParallel([&](CellType& cell) {
+        u_rates_[cell.I()] = State(GetRawRHS(cell) / cell.Measure());
+      });
+    }
+    AdvanceLevel(0, 0);
+  }
+  // One step of SSP-RK3 of level `l` from `t`, then two steps of the next
+  // level. The halo of a coarser level is interpolated between its old and
+  // new values, and that of a finer one, still at `t`, is extrapolated by
+  // the rate of its last step, so that both are second-order in time.
+  void AdvanceLevel(int l, Scalar t) {
+    if (l == rates_.CountLevels()) { return; }
+    Scalar dt = step_size_ / (1 << l);
+    level_starts_[l] = t;
+    auto& cells = rates_.GetCells(l);
+    auto& halo = rates_.GetHalo(l);
+    #pragma omp parallel for
+    for (int i = 0; i < cells.size(); ++i) {
+      auto& u = cells[i]->data.u_stages;
+      u_old_[cells[i]->I()] = u[0];
+      u[1] = u[0];
+    }
+    // Stage `s` reads `u_stages[1]` at t + kTimes[s] * dt, and adds
+    // kWeights[s] * dt times its fluxes to u^n:
+    constexpr Scalar kTimes[3] = {0, 1, 0.5};
+    constexpr Scalar kWeights[3] = {1.0 / 6, 1.0 / 6, 2.0 / 3};
+    for (int s = 0; s < 3; ++s) {
+      Scalar time = t + kTimes[s] * dt;
+      #pragma omp parallel for
+      for (int i = 0; i < halo.size(); ++i) {
+        auto& cell = *halo[i];
+        int a = rates_.GetLevel(cell);
+        auto& u = cell.data.u_stages;
+        if (a < l) {
+          Scalar ratio = (time - level_starts_[a]) / (step_size_ / (1 << a));
+          u[1] = u_old_[cell.I()] + (u[0] - u_old_[cell.I()]) * ratio;
+        } else {
+          u[1] = u[0] + u_rates_[cell.I()] * (time - t);
+        }
+      }
+      // Reconstruct the level and the halo next to it:
+      int n_cells = cells.size() + rates_.CountNeighbors(l);
+      auto get_cell = [&](int i) -> CellType& {
+        return i < cells.size() ? *cells[i] : *halo[i - cells.size()];
+      };
+      #pragma omp parallel for
+      for (int i = 0; i < n_cells; ++i) { UpdateCellBvector(get_cell(i), 1); }
+      for (int k = 0; k < n_sweeps_; ++k) {
+        #pragma omp parallel for
+        for (int i = 0; i < n_cells; ++i) {
+          ForActiveDegree(get_cell(i), [&](auto p) {
+            UpdateCellCoefficients<decltype(p)::value>(get_cell(i));
+          });
+        }
+      }
+      auto& faces = rates_.GetFaces(l);
+      #pragma omp parallel for
+      for (int i = 0; i < faces.size(); ++i) {
+        auto [edge_a, edge_b] = rates_.GetFace(faces[i]);
+        if (edge_b) {
+          GetFluxOnPeriodicEdge(*edge_a, *edge_b, 1);
+        } else {
+          GetFluxOnInteriorEdge(*edge_a, 1);
+        }
+        int l_l = rates_.GetLevel(*edge_a->GetPositiveSide());
+        int l_r = rates_.GetLevel(*edge_a->GetNegativeSide());
+        if (l_l != l_r) {
+          // The finer side's integral replaces the coarser side's:
+          Scalar weight = kWeights[s] * dt * (l == std::max(l_l, l_r) ? 1 : -1);
+          reflux_[faces[i]] += edge_a->data.flux * weight;
+        }
+      }
+      #pragma omp parallel for
+      for (int i = 0; i < cells.size(); ++i) {
+        auto& cell = *cells[i];
+        auto& u = cell.data.u_stages;
+        State u_0 = u_old_[cell.I()];
+        State value = u[1] + GatherFluxes(cell) * (dt / cell.Measure());
+        if (s == 0) {
+          u[1] = value;
+        } else if (s == 1) {
+          u[1] = u_0 * 0.75 + value * 0.25;
+        } else {
+          u[0] = u_0 * (1.0 / 3) + value * (2.0 / 3);
+        }
+      }
+    }
+    AdvanceLevel(l + 1, t);
+    AdvanceLevel(l + 1, t + dt / 2);
+    // Faces with a coarser side at level `l` are done:
+    for (int f : rates_.GetInterfaces(l)) {
+      auto* edge = rates_.GetFace(f).first;
+      auto* cell_l = edge->GetPositiveSide();
+      auto* cell_r = edge->GetNegativeSide();
+      if (rates_.GetLevel(*cell_l) == l) {
+        auto& u = cell_l->data.u_stages[0];
+        u = u - reflux_[f] / cell_l->Measure();
+      } else {
+        auto& u = cell_r->data.u_stages[0];
+        u = u + reflux_[f] / cell_r->Measure();
+      }
+      reflux_[f] = FluxType(0);
+    }
+    #pragma omp parallel for
+    for (int i = 0; i < cells.size(); ++i) {
+      int id = cells[i]->I();
+      u_rates_[id] = (cells[i]->data.u_stages[0] - u_old_[id]) * (1 / dt);
+    }
+  }
+  Scalar GetStepSize(CellType const& cell) const {
+    return stepping_ == Stepping::kLocal ? local_step_sizes_[cell.I()]
+                                         : step_size_;
+  }
+  // Largest step of forward Euler allowed in `cell` by the wave speeds of
+  // its mean value through its edges, times `cfl_` and the SSP coefficient
+  // of the scheme:
+  Scalar GetLocalStepSize(CellType& cell) const {
+    Scalar rate = 0;
+    cell.ForEachEdge([&](EdgeType& edge) {
+      rate += Riemann::GetMaxSpeed(cell.data.u_stages[0], GetNormal(edge)) *
+              edge.Measure();
+    });
+    return rate > 0 ? cfl_ * scheme_cfl_ * cell.Measure() / rate
+                    : std::numeric_limits<Scalar>::max();
+  }
+  Scalar GetStableStepSize() const {
+    return mesh_->ReduceCellsParallel(std::numeric_limits<Scalar>::max(),
+        [&](CellType& cell) { return GetLocalStepSize(cell); },
+        [](Scalar a, Scalar b) { return std::min(a, b); });
+  }
+  // Value of the reconstructed `State` of `cell` at `point`.
+  static State GetValue(CellType const& cell, int stage, PointType const& point) {
+    return Variable::FromRow(Variable::ToRow(cell.data.u_stages[stage]) +
+                             cell.Polynomial(point));
+  }
+  // Unit normal of `edge`, out of its positive side:
+  static Normal GetNormal(EdgeType const& edge) {
+    return Normal(edge.GetNormalX(), edge.GetNormalY());
   }
   void GetFluxOnInteriorEdge(EdgeType& edge, int stage) {
     auto cell_l = edge.GetPositiveSide();
     auto cell_r = edge.GetNegativeSide();
+    auto normal = GetNormal(edge);
     edge.data.flux = FluxType(0);
     edge.Integrate([&](const PointType& point) {
-        auto const& u_l = cell_l->data.u_stages[stage] + cell_l->Polynomial(point);
-        auto const& u_r = cell_r->data.u_stages[stage] + cell_r->Polynomial(point);
-        auto a = edge.GetNormalX();
-        return Riemann::GetFlux(u_l, u_r, a);
+        auto u_l = GetValue(*cell_l, stage, point);
+        auto u_r = GetValue(*cell_r, stage, point);
+        return Riemann::GetFlux(u_l, u_r, normal);
       }, &(edge.data.flux));
   }
   void GetFluxOnPeriodicEdge(EdgeType& edge_a, EdgeType& edge_b, int stage) {
     auto vec_ab = PointType(edge_b.Center() - edge_a.Center());
     auto cell_l = edge_a.GetPositiveSide();
     auto cell_r = edge_a.GetNegativeSide();
+    auto normal = GetNormal(edge_a);
     if (cell_l->Contains(&edge_a)) {
       edge_a.data.flux = FluxType(0);
       edge_a.Integrate([&](const PointType& point) {
         auto point_ab = PointType(point + vec_ab);
-        auto const& u_l = cell_l->data.u_stages[stage] + cell_l->Polynomial(point);
-        auto const& u_r = cell_r->data.u_stages[stage] + cell_r->Polynomial(point_ab);
-        auto a = edge_a.GetNormalX();
-        return Riemann::GetFlux(u_l, u_r, a);
+        auto u_l = GetValue(*cell_l, stage, point);
+        auto u_r = GetValue(*cell_r, stage, point_ab);
+        return Riemann::GetFlux(u_l, u_r, normal);
       }, &(edge_a.data.flux));
     } else {
       edge_a.data.flux = FluxType(0);
       edge_a.Integrate([&](const PointType& point) {
         auto point_ab = PointType(point + vec_ab);
-        auto const& u_l = cell_l->data.u_stages[stage] + cell_l->Polynomial(point_ab);
-        auto const& u_r = cell_r->data.u_stages[stage] + cell_r->Polynomial(point);
-        auto a = edge_a.GetNormalX();
-        return Riemann::GetFlux(u_l, u_r, a);
+        auto u_l = GetValue(*cell_l, stage, point_ab);
+        auto u_r = GetValue(*cell_r, stage, point);
+        return Riemann::GetFlux(u_l, u_r, normal);
       }, &(edge_a.data.flux));
     }
     if (cell_l == edge_b.GetPositiveSide()) { edge_b.data.flux = edge_a.data.flux; }
     else { edge_b.data.flux = -edge_a.data.flux; }
   }
+  // Same as `GetFluxOnInteriorEdge` on each interior edge, with the states on
+  // both sides of a block of edges laid out by variable (structure of arrays)
+  // for `Riemann::GetFluxes`:
+  void GetFluxOnInteriorEdges(int stage) {
+    constexpr int kVars = Variable::Count();
+    constexpr int kQuads = EdgeType::CountQuadPoints();
+    constexpr int kPoints = kFluxBlock * kQuads;
+    using FluxRow = typename Variables<FluxType>::Row;
+    auto& edges = edge_manager_.GetInteriorEdges();
+    int n_edges = edges.size();
+    auto weights = EdgeType::GetGauss().weights;
+    #pragma omp parallel for
+    for (int first = 0; first < n_edges; first += kFluxBlock) {
+      alignas(64) Scalar left[kVars][kPoints], right[kVars][kPoints];
+      alignas(64) Scalar normals[2][kPoints], fluxes[kVars][kPoints];
+      int last = std::min(first + kFluxBlock, n_edges);
+      int n = 0;
+      for (int e = first; e < last; ++e) {
+        auto& edge = *edges[e];
+        auto& cell_l = *edge.GetPositiveSide();
+        auto& cell_r = *edge.GetNegativeSide();
+        auto mean_l = Variable::ToRow(cell_l.data.u_stages[stage]);
+        auto mean_r = Variable::ToRow(cell_r.data.u_stages[stage]);
+        edge.ForEachQuadPoint([&](PointType const& point) {
+          auto u_l = (mean_l + cell_l.Polynomial(point)).eval();
+          auto u_r = (mean_r + cell_r.Polynomial(point)).eval();
+          for (int v = 0; v < kVars; ++v) {
+            left[v][n] = u_l(v);
+            right[v][n] = u_r(v);
+          }
+          normals[0][n] = edge.GetNormalX();
+          normals[1][n++] = edge.GetNormalY();
+        });
+      }
+      Riemann::GetFluxes(n, GetRows<Scalar const*>(left),
+                         GetRows<Scalar const*>(right),
+                         GetRows<Scalar const*>(normals),
+                         GetRows<Scalar*>(fluxes));
+      n = 0;
+      for (int e = first; e < last; ++e) {
+        auto flux = FluxRow::Zero().eval();
+        for (int q = 0; q < kQuads; ++q, ++n) {
+          for (int v = 0; v < kVars; ++v) {
+            flux(v) += fluxes[v][n] * weights[q];
+          }
+        }
+        auto& edge = *edges[e];
+        edge.data.flux = Variables<FluxType>::FromRow(
+            flux * Scalar(0.5 * edge.Measure()));
+      }
+    }
+  }
+  template <class Pointer, int kRows, int kCols>
+  static std::array<Pointer, kRows> GetRows(Scalar (&table)[kRows][kCols]) {
+    auto rows = std::array<Pointer, kRows>();
+    for (int i = 0; i < kRows; ++i) { rows[i] = table[i]; }
+    return rows;
+  }
   void GetFluxOnEachEdge(int stage) {
     UpdateCoefficients(stage);
-    edge_manager_.ForEachInteriorEdge([&](EdgeType& edge) {
-      GetFluxOnInteriorEdge(edge, stage);
-    });
-    edge_manager_.ForEachPeriodicEdge([&](EdgeType& edge_a, EdgeType& edge_b) {
+    if (flux_batched_) {
+      GetFluxOnInteriorEdges(stage);
+    } else {
+      edge_manager_.ForEachInteriorEdge([&](EdgeType& edge) {
+        GetFluxOnInteriorEdge(edge, stage);
+      });
+    }
+    edge_manager_.ForEachPeriodicEdge([&](EdgeType& edge_a,
+                                          EdgeType& edge_b) {
       GetFluxOnPeriodicEdge(edge_a, edge_b, stage);
     });
+    if (epsilon_ > 0) {
+      smoothing_.Smooth([&](CellType& cell) {
+        return GetRawRHS(cell);
+      }, epsilon_, n_smoothing_sweeps_);
+    }
+    // The first evaluation of a step is at u^n, so its residual comes for
+    // free:
+    if (monitor_step_ >= 0) {
+      residuals_.emplace_back(GetResidualNorms(*mesh_, [&](CellType& cell) {
+        return Variables<FluxType>::ToRow(GetRawRHS(cell) / cell.Measure());
+      }));
+      residual_steps_.emplace_back(monitor_step_);
+      monitor_step_ = -1;
+    }
   }
+  // The residual of `cell` stepped with, smoothed if asked:
   FluxType GetRHS(CellType& cell) {
+    return epsilon_ > 0 ? smoothing_.GetResidual(cell) : GetRawRHS(cell);
+  }
+  FluxType GetRawRHS(CellType& cell) {
+    auto rhs = GatherFluxes(cell);
+    if (forced_) { rhs += p_forcing_[cell.I()]; }
+    return rhs;
+  }
+  // Sum of the fluxes into `cell` from `edge.data.flux` of its edges:
+  static FluxType GatherFluxes(CellType& cell) {
     auto rhs = FluxType();
     cell.ForEachEdge([&](EdgeType& edge) {
       if (edge.GetPositiveSide() == &cell) { rhs -= edge.data.flux; }
@@ -183,56 +814,395 @@ class Rkvr {
     return rhs;
   }
   void InitializeVrMatrix() {
-    edge_manager_.ForEachInteriorEdge([&](EdgeType& edge) {
-      edge.InitializeBmat();
-    });
-    edge_manager_.ForEachPeriodicEdge([&](EdgeType& edge_a, EdgeType& edge_b) {
-      auto vec_ab = PointType(edge_b.Center() - edge_a.Center());
-      edge_a.InitializeBmat(vec_ab);
-      edge_b.b_matrix = edge_a.b_matrix;
-    });
+    auto cache = VrCache<Mesh>(cache_file_);
+    if constexpr (kShared) {
+      pool_.Build(*mesh_, edge_manager_);
+    } else if constexpr (kBatched) {
+      // Built into the blocks by `BuildBatch`.
+    } else if (cache_file_.empty() || !cache.Load(mesh_.get())) {
+      if constexpr (!kMatrixFree) {
+        edge_manager_.ForEachInteriorEdge([&](EdgeType& edge) {
+          edge.InitializeBmat();
+        });
+        edge_manager_.ForEachPeriodicEdge([&](EdgeType& edge_a, EdgeType& edge_b) {
+          auto vec_ab = PointType(edge_b.Center() - edge_a.Center());
+          edge_a.InitializeBmat(vec_ab);
+          edge_b.b_matrix = edge_a.b_matrix;
+        });
+      }
+      if (batched_) {
+        VrBatch<Mesh>::InitializeAmatInv(GetCells());
+      }
+      mesh_->ForEachCellParallel([&](CellType& cell) {
+        if (!batched_) { cell.InitializeAmatInv(); }
+        cell.InitializeBvecMat();
+      });
+      if (!cache_file_.empty()) { cache.Save(*mesh_); }
+    }
     mesh_->ForEachCellParallel([&](CellType& cell) {
-      cell.InitializeAmatInv();
-      cell.InitializeBvecMat();
+      cell.b_vector = Coefficients::Zero();
       cell.data.Initialize();
     });
+    if (batched_ || kBatched) { BuildBatch(); }
+    if (tile_size_ > 0) { tiles_.Build(GetCells(), tile_size_); }
+    if (epsilon_ > 0) { smoothing_.Build(GetCells()); }
+    if (n_levels_ > 0) {
+      multigrid_.Build(edge_manager_.GetFaces(), GetCells(), n_levels_);
+    }
   }
-  void UpdateCoefficients(int stage) {
+  std::vector<CellType*> GetCells() const {
+    auto cells = std::vector<CellType*>();
+    cells.reserve(mesh_->CountCells());
+    mesh_->ForEachCell([&](CellType& cell) { cells.emplace_back(&cell); });
+    return cells;
+  }
+  void BuildBatch() {
+    if constexpr (kBatched) {
+      // Straight from the geometry, with the VR matrices inverted in place:
+      batch_.Build(GetCells(), [&](CellType& cell) {
+        return cell.BuildAmat();
+      }, [&](CellType& cell) {
+        typename CellType::Matrix3V b_vector_mat;
+        cell.BuildBvecMat(&b_vector_mat);
+        return b_vector_mat;
+      }, [&](CellType& cell, EdgeType& edge, int i) -> Matrix {
+        auto* that = edge.GetOpposite(&cell);
+        if (!that) { return Matrix::Zero(); }
+        auto shift = edge_manager_.GetPeriodicShift(edge);
+        return cell.BuildBmat(edge, *that, shift);
+      });
+      batch_.InvertAmat();
+    } else if constexpr (!kMatrixFree) {
+      batch_.Build(GetCells(), [&](CellType& cell) {
+        return GetAmatInv<degree>(cell);
+      }, [&](CellType& cell) -> auto const& {
+        return GetBvecMat(cell);
+      }, [&](CellType& cell, EdgeType& edge, int i) -> Matrix {
+        auto* that = edge.GetOpposite(&cell);
+        if (!that) {
+          return Matrix::Zero();
+        } else if constexpr (kShared) {
+          return pool_.GetBmat(cell, i);
+        } else if (that->I() < cell.I()) {
+          return edge.b_matrix;
+        } else {
+          return edge.b_matrix.transpose();
+        }
+      });
+    }
+  }
+  // Move each node by `displacements[node.I()]`, then update the geometry and
+  // the VR operators around the moved nodes. Operators between two cells are
+  // kept if both of them are translated by the same shift. The shared pool of
+  // `kShared` storage is keyed by shape, so it is rebuilt as a whole, and
+  // serially, if any cell is deformed. So are the structures built from the
+  // measures: the VR batch, the smoothing, the multigrid levels, LU-SGS and
+  // the multirate levels.
+  void MoveNodes(std::vector<PointType> const& displacements) {
+    auto zero = PointType(0, 0);
+    mesh_->ForEachNode([&](NodeType& node) {
+      if (displacements[node.I()] != zero) {
+        mesh_->MoveNode(node.I(), displacements[node.I()]);
+      }
+    });
+    auto rigid = std::vector<char>(mesh_->CountCells());
+    auto shifts = std::vector<PointType>(mesh_->CountCells());
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      auto const& shift = displacements[cell.A().I()];
+      rigid[cell.I()] = (shift == displacements[cell.B().I()] &&
+                         shift == displacements[cell.C().I()]);
+      shifts[cell.I()] = shift;
+      if (!rigid[cell.I()]) {
+        cell.UpdateGeometry();
+      } else if (shift != zero) {
+        cell.Move(shift);
+      }
+    });
+    mesh_->ForEachEdgeParallel([&](EdgeType& edge) {
+      auto const& shift = displacements[edge.Head().I()];
+      if (shift != displacements[edge.Tail().I()]) {
+        edge.UpdateGeometry();
+      } else if (shift != zero) {
+        edge.Move(shift);
+      }
+    });
+    auto kept = [&](CellType const& cell_l, CellType const& cell_r) {
+      return rigid[cell_l.I()] && rigid[cell_r.I()] &&
+             shifts[cell_l.I()] == shifts[cell_r.I()];
+    };
+    edge_manager_.ForEachInteriorEdge([&](EdgeType& edge) {
+      auto cell_l = edge.GetPositiveSide();
+      auto cell_r = edge.GetNegativeSide();
+      if (kept(*cell_l, *cell_r)) { return; }
+      edge.distance = (cell_l->Center() - cell_r->Center()).norm();
+      if constexpr (EdgeType::kStoresBmat) {
+        edge.b_matrix.setZero();
+        edge.InitializeBmat();
+      }
+    });
+    edge_manager_.ForEachPeriodicEdge([&](EdgeType& edge_a, EdgeType& edge_b) {
+      if (kept(*edge_a.GetPositiveSide(), *edge_a.GetNegativeSide())) { return; }
+      edge_manager_.UpdatePeriodicGeometry(&edge_a, &edge_b);
+      if constexpr (EdgeType::kStoresBmat) {
+        auto vec_ab = PointType(edge_b.Center() - edge_a.Center());
+        edge_a.b_matrix.setZero();
+        edge_a.InitializeBmat(vec_ab);
+        edge_b.b_matrix = edge_a.b_matrix;
+      }
+    });
+    auto renewed = std::vector<char>(mesh_->CountCells());
     mesh_->ForEachCellParallel([&](CellType& cell) {
-      Eigen::Matrix<Scalar, 3, 1> vec;
-      int i = 0;
       cell.ForEachEdge([&](EdgeType& edge) {
-        vec(i++) = edge.GetOpposite(&cell)->data.u_stages[stage] - cell.data.u_stages[stage];
+        if (auto* that = edge.GetOpposite(&cell)) {
+          renewed[cell.I()] |= !kept(cell, *that);
+        } else {
+          renewed[cell.I()] |= !rigid[cell.I()];
+        }
       });
-      cell.b_vector = cell.b_vector_mat * vec;
+      if constexpr (CellType::kOwnsVr) {
+        if (renewed[cell.I()]) {
+          cell.InitializeAmatInv();
+          cell.BuildBvecMat(&cell.b_vector_mat);
+        }
+      }
     });
-    for (int i = 0; i < 9; ++i) {
-      mesh_->ForEachCellParallel([&](CellType& cell) {
-        cell.data.coefficients *= -0.3;
-        Vector temp = Vector::Zero();
-        cell.ForEachEdge([&](EdgeType& edge) {
-          CellType* neighber = edge.GetOpposite(&cell);
-          if (neighber->I() < cell.I()) {
-            temp += (cell.a_matrix_inv * edge.b_matrix) * neighber->data.coefficients;
+    if constexpr (kShared) {
+      if (std::count(renewed.begin(), renewed.end(), 1)) {
+        pool_.Build(*mesh_, edge_manager_);
+      }
+    }
+    if (batched_ || kBatched) { BuildBatch(); }
+    if (epsilon_ > 0) { smoothing_.Build(GetCells()); }
+    if (n_levels_ > 0) {
+      multigrid_.Build(edge_manager_.GetFaces(), GetCells(), n_levels_);
+    }
+    // Rebuilt by their next step:
+    lu_sgs_.Clear();
+    rates_.Clear();
+  }
+  // VR operators of `cell`, wherever they are kept:
+  template <int kP>
+  auto GetAmatInv(CellType const& cell) const {
+    if constexpr (kShared) {
+      return pool_.template GetAmatInv<kP>(cell);
+    } else {
+      return cell.template GetAmatInv<kP>();
+    }
+  }
+  auto const& GetBvecMat(CellType const& cell) const {
+    if constexpr (kShared) {
+      return pool_.GetBvecMat(cell);
+    } else {
+      return cell.b_vector_mat;
+    }
+  }
+  // Visit the active degree of `cell` as a compile-time constant:
+  template <int kP = degree, class Visitor>
+  static void ForActiveDegree(CellType const& cell, Visitor&& visit) {
+    if constexpr (kP > 0) {
+      if (cell.ActiveDegree() == kP) {
+        visit(std::integral_constant<int, kP>());
+      } else {
+        ForActiveDegree<kP - 1>(cell, visit);
+      }
+    }
+  }
+  // Jumps of the cell averages from `cell` to its neighbors, one row per edge:
+  static auto GetJumps(CellType& cell, int stage) {
+    Eigen::Matrix<Scalar, 3, Variable::Count()> jumps;
+    auto u_cell = Variable::ToRow(cell.data.u_stages[stage]);
+    int i = 0;
+    cell.ForEachEdge([&](EdgeType& edge) {
+      auto* that = edge.GetOpposite(&cell);
+      if (that) {
+        jumps.row(i++) = Variable::ToRow(that->data.u_stages[stage]) - u_cell;
+      } else {
+        jumps.row(i++).setZero();
+      }
+    });
+    return jumps;
+  }
+  void UpdateCoefficients(int stage) {
+    last_stage_ = stage;
+    // Cell means only:
+    if (coarse_degree_ == 0) { return; }
+    bool batched = kBatched || (batched_ && !adaptive_ && coarse_degree_ < 0);
+    if (batched && !batch_.Empty()) {
+      batch_.UpdateBvector([&](CellType& cell) {
+        return GetJumps(cell, stage);
+      }, predict_);
+      for (int i = 0; i < n_sweeps_; ++i) { batch_.Sweep(); }
+      return;
+    }
+    // There are no per-cell operators to sweep with otherwise:
+    if constexpr (!kBatched) {
+      if (tile_size_ > 0 && !tiles_.Empty()) {
+        tiles_.ForEachStep(n_sweeps_ + 1, [&](CellType& cell, int k) {
+          if (k == 0) {
+            UpdateCellBvector(cell, stage);
           } else {
-            temp += (cell.a_matrix_inv * edge.b_matrix.transpose()) * neighber->data.coefficients;
+            ForActiveDegree(cell, [&](auto p) {
+              UpdateCellCoefficients<decltype(p)::value>(cell);
+            });
           }
         });
-        temp += cell.a_matrix_inv * cell.b_vector;
-        cell.data.coefficients += temp * 1.3;
+        return;
+      }
+      mesh_->ForEachCellParallel([&](CellType& cell) {
+        UpdateCellBvector(cell, stage);
       });
+      for (int i = 0; i < n_sweeps_; ++i) {
+        mesh_->ForEachCellParallel([&](CellType& cell) {
+          ForActiveDegree(cell, [&](auto p) {
+            UpdateCellCoefficients<decltype(p)::value>(cell);
+          });
+        });
+      }
     }
   }
+  void UpdateCellBvector(CellType& cell, int stage) const {
+    Coefficients b_vector = GetBvecMat(cell) * GetJumps(cell, stage);
+    if (predict_) {
+      // The VR system is linear in `b_vector`, so mapping its increment
+      // through the cached inverse moves the old solution towards the new one.
+      ForActiveDegree(cell, [&](auto p) {
+        constexpr int n = CellType::CountCoef(decltype(p)::value);
+        cell.data.coefficients.template topRows<n>() +=
+            GetAmatInv<decltype(p)::value>(cell) *
+            (b_vector - cell.b_vector).template topRows<n>();
+      });
+    }
+    cell.b_vector = b_vector;
+  }
+  template <int kP>
+  void UpdateCellCoefficients(CellType& cell) const {
+    constexpr int n = CellType::CountCoef(kP);
+    // Each matrix is loaded once and applied to all variables together.
+    Eigen::Matrix<Scalar, n, Variable::Count()> temp =
+        cell.b_vector.template topRows<n>();
+    int i = 0;
+    cell.ForEachEdge([&](EdgeType& edge) {
+      CellType* neighber = edge.GetOpposite(&cell);
+      if (!neighber) {
+        ++i;
+      } else if constexpr (kShared) {
+        temp.noalias() += pool_.GetBmat(cell, i++).template topRows<n>() *
+                          neighber->data.coefficients;
+      } else if constexpr (kMatrixFree) {
+        edge.template ApplyBmat<n>(cell, edge_manager_.GetPeriodicShift(edge),
+                                   neighber->data.coefficients, &temp);
+      } else if (neighber->I() < cell.I()) {
+        temp.noalias() += edge.b_matrix.template topRows<n>() *
+                          neighber->data.coefficients;
+      } else {
+        temp.noalias() += edge.b_matrix.template leftCols<n>().transpose() *
+                          neighber->data.coefficients;
+      }
+    });
+    auto coefficients = cell.data.coefficients.template topRows<n>();
+    coefficients *= -0.3;
+    coefficients.noalias() += (GetAmatInv<kP>(cell) * temp) * 1.3;
+  }
+  // Set the active degree of each cell from the jumps of its reconstruction
+  // on the faces, measured with the coefficients of the last stage.
+  void UpdateDegrees() {
+    int stage = last_stage_;
+    degrees_.resize(mesh_->CountCells());
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      auto u_cell = Variable::ToRow(cell.data.u_stages[stage]);
+      Scalar scale = u_cell.cwiseAbs().maxCoeff();
+      Scalar jump = 0, jump_mean = 0, jump_linear = 0;
+      cell.ForEachEdge([&](EdgeType& edge) {
+        auto* that = edge.GetOpposite(&cell);
+        if (!that) { return; }
+        auto point = edge.Center();
+        auto point_that = PointType(point + edge_manager_.GetPeriodicShift(edge));
+        auto u_that = Variable::ToRow(that->data.u_stages[stage]);
+        auto jump_at = [&](int p, int q) {
+          auto u_l = (u_cell + cell.Polynomial(point, p)).eval();
+          auto u_r = (u_that + that->Polynomial(point_that, q)).eval();
+          return (u_r - u_l).cwiseAbs().maxCoeff();
+        };
+        scale = std::max(scale, u_that.cwiseAbs().maxCoeff());
+        jump_mean = std::max(jump_mean, (u_that - u_cell).cwiseAbs().maxCoeff());
+        jump = std::max(jump, jump_at(cell.ActiveDegree(), that->ActiveDegree()));
+        jump_linear = std::max(jump_linear, jump_at(1, 1));
+      });
+      // Smooth data gives jump = O(h^(p+1)) against jump_mean = O(h).
+      Scalar tiny = scale * 1e-6 + 1e-30;
+      bool troubled = jump > trouble_tol_ * (jump_mean + tiny);
+      bool linear = jump_linear <= smooth_tol_ * (scale + tiny);
+      degrees_[cell.I()] = (troubled || linear) ? 1 : degree;
+    });
+    mesh_->ForEachCellParallel([&](CellType& cell) {
+      if (cell.ActiveDegree() != degrees_[cell.I()]) {
+        cell.SetActiveDegree(degrees_[cell.I()]);
+      }
+    });
+  }
   std::string model_name_;
   Reader reader_;
   Writer writer_;
   std::unique_ptr<Mesh> mesh_;
-  Scalar duration_;
-  int n_steps_;
-  Scalar step_size_;
+  Scalar duration_{0};
+  int n_steps_{0};
+  Scalar step_size_{0};
   std::string dir_;
-  int refresh_rate_;
+  std::string cache_file_;
+  int refresh_rate_{1};
+  Scalar cfl_{0};
+  Scalar output_interval_{0};
+  std::vector<Scalar> step_sizes_;
+  int monitor_rate_{0};
+  Scalar tolerance_{0};
+  int monitor_step_{-1};
+  std::vector<ResidualNorms> residuals_;
+  std::vector<int> residual_steps_;
+  Stepping stepping_{Stepping::kFixed};
+  void (Rkvr::*stepper_)() = &Rkvr::ShuOsherStepper<SspRk33>;
+  Scalar scheme_cfl_{SspRk33::Cfl()};
+  bool multicolor_{false};
+  Scalar omega_;
+  int n_levels_{0};
+  int n_coarse_steps_{2};
+  Scalar coarse_cfl_{1};
+  Multigrid<Mesh, Riemann> multigrid_;
+  int n_p_steps_{0};
+  // Degree of all cells during a p-multigrid cycle, or -1:
+  int coarse_degree_{-1};
+  bool forced_{false};
+  std::vector<FluxType> p_forcing_;
+  std::vector<int> saved_degrees_;
+  std::vector<Coefficients> saved_coefficients_;
+  Scalar epsilon_{0};
+  int n_smoothing_sweeps_{2};
+  ResidualSmoothing<Mesh, FluxType> smoothing_;
+  int n_rate_levels_{1};
+  MultirateLevels<Mesh> rates_;
+  std::vector<int> rate_levels_;
+  std::vector<Scalar> level_starts_;
+  std::vector<State> u_old_;
+  // Rate of change of the means over the last step of each cell:
+  std::vector<State> u_rates_;
+  std::vector<FluxType> reflux_;
+  bool prepared_{false};
+  LuSgs<Mesh, Riemann> lu_sgs_;
+  std::vector<Scalar> local_step_sizes_;
+  int n_sweeps_{9};
+  bool predict_{false};
+  int last_stage_{0};
+  bool adaptive_{false};
+  Scalar trouble_tol_;
+  Scalar smooth_tol_;
+  std::vector<int> degrees_;
   Manager<Mesh> edge_manager_;
+  VrPool<Mesh> pool_;
+  bool batched_{false};
+  VrBatch<Mesh> batch_;
+  int tile_size_{0};
+  VrTiles<Mesh> tiles_;
+  static constexpr int kFluxBlock = algebra::kLanes;
+  bool flux_batched_{false};
 };
 
 }  // namespace solver
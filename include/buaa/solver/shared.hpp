@@ -0,0 +1,127 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_SHARED_HPP_
+#define INCLUDE_BUAA_SOLVER_SHARED_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// VR operators of a `Mesh` with one instance per shape: the basis is centered
+// and scaled per cell, so translated cells (and translated pairs of cells) have
+// equal matrices. Cells refer to them by the indices kept here, by `I()`.
+template <class Mesh>
+class VrPool {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+  using PointType = typename Mesh::Point;
+  using Matrix = typename CellType::Matrix;
+  using Matrix3V = typename CellType::Matrix3V;
+  using LowInv = typename CellType::LowInv;
+  using Key = std::vector<long long>;
+  struct CellOperators {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Matrix a_matrix_inv;
+    LowInv a_matrix_low_inv;
+    Matrix3V b_vector_mat;
+  };
+  template <class T>
+  using AlignedVector = std::vector<T, Eigen::aligned_allocator<T>>;
+
+ public:
+  // Build the operators of the cells of `mesh`, in which the neighbor across
+  // `edge` is seen shifted by `manager.GetPeriodicShift(edge)`.
+  template <class Manager>
+  void Build(Mesh const& mesh, Manager const& manager) {
+    Clear();
+    Scalar length = std::numeric_limits<Scalar>::max();
+    mesh.ForEachCell([&](CellType& cell) {
+      length = std::min(length, std::sqrt(cell.Measure()));
+    });
+    // Coordinates equal within `tolerance` are taken as the same:
+    Scalar tolerance = length * 1e-5;
+    cell_to_operators_.resize(mesh.CountCells());
+    cell_to_bmats_.resize(mesh.CountCells());
+    std::map<Key, mesh::Id> cell_keys, edge_keys;
+    mesh.ForEachCell([&](CellType& cell) {
+      auto origin = PointType(cell.A());
+      auto add = [&](Key* key, PointType const& point) {
+        key->emplace_back(std::llround((point.X() - origin.X()) / tolerance));
+        key->emplace_back(std::llround((point.Y() - origin.Y()) / tolerance));
+      };
+      auto cell_key = Key();
+      add(&cell_key, cell.B());
+      add(&cell_key, cell.C());
+      cell.ForEachEdge([&](EdgeType& edge) {
+        add(&cell_key, edge.Head());
+        add(&cell_key, edge.Tail());
+        cell_key.emplace_back(std::llround(edge.distance / tolerance));
+      });
+      auto [cell_iter, cell_new] = cell_keys.emplace(cell_key, cell_keys.size());
+      if (cell_new) {
+        auto& operators = cell_operators_.emplace_back();
+        cell.BuildAmatInv(&operators.a_matrix_inv, &operators.a_matrix_low_inv);
+        cell.BuildBvecMat(&operators.b_vector_mat);
+      }
+      cell_to_operators_[cell.I()] = cell_iter->second;
+      int i = 0;
+      cell.ForEachEdge([&](EdgeType& edge) {
+        CellType* that = edge.GetOpposite(&cell);
+        auto shift = manager.GetPeriodicShift(edge);
+        auto edge_key = cell_key;
+        add(&edge_key, PointType(that->A() - shift));
+        add(&edge_key, PointType(that->B() - shift));
+        add(&edge_key, PointType(that->C() - shift));
+        edge_key.emplace_back(i);
+        auto [edge_iter, edge_new] = edge_keys.emplace(edge_key, edge_keys.size());
+        if (edge_new) {
+          b_matrices_.emplace_back(cell.BuildBmat(edge, *that, shift));
+        }
+        cell_to_bmats_[cell.I()][i++] = edge_iter->second;
+      });
+    });
+  }
+  void Clear() {
+    cell_operators_.clear();
+    b_matrices_.clear();
+    cell_to_operators_.clear();
+    cell_to_bmats_.clear();
+  }
+  // Accessors:
+  auto CountCellOperators() const { return cell_operators_.size(); }
+  auto CountBmats() const { return b_matrices_.size(); }
+  template <int kP>
+  auto GetAmatInv(CellType const& cell) const {
+    auto& operators = cell_operators_[cell_to_operators_[cell.I()]];
+    return CellType::template GetAmatInv<kP>(operators.a_matrix_inv,
+                                             operators.a_matrix_low_inv);
+  }
+  Matrix3V const& GetBvecMat(CellType const& cell) const {
+    return cell_operators_[cell_to_operators_[cell.I()]].b_vector_mat;
+  }
+  // `b_matrix` of the `i`-th edge of `cell`, whose rows belong to `cell`:
+  Matrix const& GetBmat(CellType const& cell, int i) const {
+    return b_matrices_[cell_to_bmats_[cell.I()][i]];
+  }
+
+ private:
+  AlignedVector<CellOperators> cell_operators_;
+  AlignedVector<Matrix> b_matrices_;
+  std::vector<mesh::Id> cell_to_operators_;
+  std::vector<std::array<mesh::Id, 3>> cell_to_bmats_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_SHARED_HPP_
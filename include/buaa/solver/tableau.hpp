@@ -0,0 +1,197 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_TABLEAU_HPP_
+#define INCLUDE_BUAA_SOLVER_TABLEAU_HPP_
+
+#include <array>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Shu-Osher form of an explicit Runge-Kutta scheme: row `i` gives
+//   u^(i+1) = sum_{k <= i} alpha[i][k] * u^(k) + beta[i][k] * dt * L(u^(k)),
+// with u^(0) = u^n and u^(kStages) = u^{n+1}.
+template <int kStages>
+struct ShuOsher {
+  std::array<std::array<double, kStages>, kStages> alpha{};
+  std::array<std::array<double, kStages>, kStages> beta{};
+};
+
+// The Shu-Osher form of the Butcher tableau `a`, `b`:
+template <int kStages>
+constexpr ShuOsher<kStages> FromButcher(
+    std::array<std::array<double, kStages>, kStages> const& a,
+    std::array<double, kStages> const& b) {
+  auto tableau = ShuOsher<kStages>();
+  for (int i = 0; i < kStages; ++i) {
+    tableau.alpha[i][0] = 1;
+    for (int k = 0; k <= i; ++k) {
+      tableau.beta[i][k] = (i + 1 < kStages ? a[i + 1][k] : b[k]);
+    }
+  }
+  return tableau;
+}
+
+// The same scheme with L evaluated once per stage, at the latest stage value:
+// each other L(u^(k)) is replaced by the stage values it produced, which needs
+// beta[k][k] != 0.
+template <int kStages>
+constexpr ShuOsher<kStages> ReduceShuOsher(ShuOsher<kStages> const& input) {
+  // L(u^(k)) = sum_m residuals[k][m] * u^(m):
+  std::array<std::array<double, kStages + 1>, kStages> residuals{};
+  auto output = ShuOsher<kStages>();
+  for (int i = 0; i < kStages; ++i) {
+    std::array<double, kStages + 1> alpha{};
+    for (int k = 0; k <= i; ++k) { alpha[k] = input.alpha[i][k]; }
+    for (int k = 0; k < i; ++k) {
+      for (int m = 0; m <= k + 1; ++m) {
+        alpha[m] += input.beta[i][k] * residuals[k][m];
+      }
+    }
+    for (int k = 0; k <= i; ++k) { output.alpha[i][k] = alpha[k]; }
+    output.beta[i][i] = input.beta[i][i];
+    if (input.beta[i][i] != 0) {
+      residuals[i][i + 1] = 1 / input.beta[i][i];
+      for (int m = 0; m <= i; ++m) {
+        residuals[i][m] = -alpha[m] / input.beta[i][i];
+      }
+    }
+  }
+  return output;
+}
+
+// Whether `ReduceShuOsher` keeps each L(u^(k)) of `tableau`, i.e. whether
+// beta[k][k] != 0 for each beta[i][k] != 0.
+template <int kStages>
+constexpr bool IsReducible(ShuOsher<kStages> const& tableau) {
+  for (int i = 0; i < kStages; ++i) {
+    for (int k = 0; k < i; ++k) {
+      if (tableau.beta[i][k] != 0 && tableau.beta[k][k] == 0) { return false; }
+    }
+  }
+  return true;
+}
+
+// Slots of `u_stages` holding each u^(k) of a reduced scheme: stage `i` reads
+// u^(i) and each u^(k) with alpha[i][k] != 0, and writes u^(i+1) to the first
+// slot whose value is not read after it. u^n and u^{n+1} are in slot 0.
+template <int kStages>
+constexpr std::array<int, kStages + 1> AllocateSlots(
+    ShuOsher<kStages> const& tableau) {
+  std::array<int, kStages + 1> last_read{};
+  for (int k = 0; k <= kStages; ++k) { last_read[k] = k; }
+  for (int i = 0; i < kStages; ++i) {
+    for (int k = 0; k <= i; ++k) {
+      if (tableau.alpha[i][k] != 0) { last_read[k] = i; }
+    }
+  }
+  std::array<int, kStages + 1> slots{};
+  for (int i = 0; i + 1 < kStages; ++i) {
+    for (int slot = 0; ; ++slot) {
+      bool taken = false;
+      for (int k = 0; k <= i; ++k) {
+        taken |= (slots[k] == slot && last_read[k] > i);
+      }
+      if (!taken) {
+        slots[i + 1] = slot;
+        break;
+      }
+    }
+  }
+  slots[kStages] = 0;
+  return slots;
+}
+
+// Steps of `Scheme` as run by `Rkvr`, with one evaluation of L per stage:
+template <class Scheme>
+struct ShuOsherSteps {
+  static_assert(IsReducible(Scheme::Tableau()),
+                "Some L(u^(k)) of the scheme is not of a stage value.");
+  static constexpr auto kTableau = ReduceShuOsher(Scheme::Tableau());
+  static constexpr int kStages = kTableau.alpha.size();
+  // Slot of `u_stages` holding u^(k):
+  static constexpr auto kSlots = AllocateSlots(kTableau);
+  static constexpr int CountSlots() {
+    int n = 0;
+    for (int slot : kSlots) { n = (slot < n ? n : slot + 1); }
+    return n;
+  }
+  static constexpr mesh::Scalar Alpha(int i, int k) {
+    return kTableau.alpha[i][k];
+  }
+  static constexpr mesh::Scalar Beta(int i) { return kTableau.beta[i][i]; }
+};
+
+// Shu and Osher's SSP-RK(3,3), whose SSP coefficient is 1.
+struct SspRk33 {
+  static constexpr mesh::Scalar Cfl() { return 1; }
+  static constexpr ShuOsher<3> Tableau() {
+    auto tableau = ShuOsher<3>();
+    tableau.alpha = {{{1, 0, 0}, {0.75, 0.25, 0}, {1.0 / 3, 0, 2.0 / 3}}};
+    tableau.beta = {{{1, 0, 0}, {0, 0.25, 0}, {0, 0, 2.0 / 3}}};
+    return tableau;
+  }
+};
+
+// Spiteri and Ruuth's SSP-RK(5,4), whose SSP coefficient is 1.508.
+struct SspRk54 {
+  static constexpr mesh::Scalar Cfl() { return 1.508; }
+  static constexpr ShuOsher<5> Tableau() {
+    auto tableau = ShuOsher<5>();
+    tableau.alpha[0][0] = 1;
+    tableau.beta[0][0] = 0.391752226571890;
+    tableau.alpha[1][0] = 0.444370493651235;
+    tableau.alpha[1][1] = 0.555629506348765;
+    tableau.beta[1][1] = 0.368410593050371;
+    tableau.alpha[2][0] = 0.620101851488403;
+    tableau.alpha[2][2] = 0.379898148511597;
+    tableau.beta[2][2] = 0.251891774271694;
+    tableau.alpha[3][0] = 0.178079954393132;
+    tableau.alpha[3][3] = 0.821920045606868;
+    tableau.beta[3][3] = 0.544974750228521;
+    tableau.alpha[4][2] = 0.517231671970585;
+    tableau.alpha[4][3] = 0.096059710526147;
+    tableau.beta[4][3] = 0.063692468666290;
+    tableau.alpha[4][4] = 0.386708617503269;
+    tableau.beta[4][4] = 0.226007483236906;
+    return tableau;
+  }
+};
+
+// Ketcheson's SSP-RK(10,4), whose SSP coefficient is 6. See `Ssp104` for its
+// two-register form.
+struct SspRk104 {
+  static constexpr mesh::Scalar Cfl() { return 6; }
+  static constexpr ShuOsher<10> Tableau() {
+    auto tableau = ShuOsher<10>();
+    for (int i = 0; i < 10; ++i) {
+      tableau.alpha[i][i] = 1;
+      tableau.beta[i][i] = 1.0 / 6;
+    }
+    tableau.alpha[4][0] = 0.6;
+    tableau.alpha[4][4] = 0.4;
+    tableau.beta[4][4] = 1.0 / 15;
+    tableau.alpha[9][0] = 1.0 / 25;
+    tableau.alpha[9][4] = 9.0 / 25;
+    tableau.beta[9][4] = 3.0 / 50;
+    tableau.alpha[9][9] = 3.0 / 5;
+    tableau.beta[9][9] = 1.0 / 10;
+    return tableau;
+  }
+};
+
+// The classic fourth-order scheme, which is not SSP.
+struct ClassicRk4 {
+  static constexpr mesh::Scalar Cfl() { return 1; }
+  static constexpr ShuOsher<4> Tableau() {
+    return FromButcher<4>({{{0, 0, 0, 0}, {0.5, 0, 0, 0}, {0, 0.5, 0, 0},
+                            {0, 0, 1, 0}}},
+                          {1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6});
+  }
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_TABLEAU_HPP_
@@ -0,0 +1,41 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_VARIABLES_HPP_
+#define INCLUDE_BUAA_SOLVER_VARIABLES_HPP_
+
+#include <Eigen/Dense>
+
+#include "buaa/riemann/types.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Maps a `State` to the row of variables reconstructed on each cell, so that
+// all variables of a cell share one pass over its VR matrices.
+template <class State>
+struct Variables;
+
+template <>
+struct Variables<riemann::Scalar> {
+  using Scalar = riemann::Scalar;
+  using Row = Eigen::Matrix<Scalar, 1, 1>;
+  static constexpr int Count() { return 1; }
+  static Row ToRow(Scalar const& state) { return Row(state); }
+  static Scalar FromRow(Row const& row) { return row(0); }
+};
+
+template <template <int> class Tuple, int kDim>
+struct Variables<Tuple<kDim>> {
+  using Scalar = riemann::Scalar;
+  using Row = Eigen::Matrix<Scalar, 1, kDim + 2>;
+  static constexpr int Count() { return kDim + 2; }
+  // The tuple is packed, so its row is a mere transpose:
+  static Row ToRow(Tuple<kDim> const& state) { return state.transpose(); }
+  static Tuple<kDim> FromRow(Row const& row) {
+    return Tuple<kDim>(row.transpose());
+  }
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_VARIABLES_HPP_
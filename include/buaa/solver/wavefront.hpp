@@ -0,0 +1,90 @@
+// Copyright 2021 Minghao Yang
+#ifndef INCLUDE_BUAA_SOLVER_WAVEFRONT_HPP_
+#define INCLUDE_BUAA_SOLVER_WAVEFRONT_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include "buaa/mesh/dim2.hpp"
+
+namespace buaa {
+namespace solver {
+
+// Tiles of cells run through several steps (e.g. the VR sweeps of a stage) as
+// a wavefront, so that the operators of a tile are used by all steps while
+// still in cache, instead of streamed from memory once per step.
+// Each tile is a range of breadth-first levels of the cell graph, hence only
+// couples to the tiles before and after it. Step `k` of tile `t` runs in wave
+// `t + 2 * k`, after step `k` of tile `t - 1` and step `k - 1` of tile `t + 1`,
+// but before step `k` of the latter: exactly the order of running each step
+// over all cells tile by tile, while the tiles of a wave are independent.
+template <class Mesh>
+class VrTiles {
+  using CellType = typename Mesh::Cell;
+  using EdgeType = typename Mesh::Edge;
+
+ public:
+  // Split `cells` into tiles of at least `min_size` cells.
+  void Build(std::vector<CellType*> const& cells, int min_size) {
+    Clear();
+    auto level = std::vector<int>(cells.size(), -1);
+    auto queue = std::vector<CellType*>();
+    queue.reserve(cells.size());
+    int n_levels = 0;
+    for (auto* root : cells) {
+      if (level[root->I()] >= 0) { continue; }
+      // Levels of different components never touch, so may share a tile.
+      level[root->I()] = n_levels;
+      queue.emplace_back(root);
+      for (int head = queue.size() - 1; head < queue.size(); ++head) {
+        auto* cell = queue[head];
+        n_levels = std::max(n_levels, level[cell->I()] + 1);
+        cell->ForEachEdge([&](EdgeType& edge) {
+          auto* that = edge.GetOpposite(cell);
+          if (that && level[that->I()] < 0) {
+            level[that->I()] = level[cell->I()] + 1;
+            queue.emplace_back(that);
+          }
+        });
+      }
+    }
+    // `queue` is sorted by level, so each tile is a range of it:
+    int begin = 0;
+    for (int end = 0; end < queue.size(); ++end) {
+      bool last_of_level = end + 1 == queue.size() ||
+          level[queue[end + 1]->I()] != level[queue[end]->I()];
+      if (last_of_level && end + 1 - begin >= min_size) {
+        tiles_.emplace_back(queue.begin() + begin, queue.begin() + end + 1);
+        begin = end + 1;
+      }
+    }
+    if (begin < queue.size()) {
+      tiles_.emplace_back(queue.begin() + begin, queue.end());
+    }
+  }
+  void Clear() { tiles_.clear(); }
+  bool Empty() const { return tiles_.empty(); }
+  auto CountTiles() const { return tiles_.size(); }
+  // Call `visitor(cell, k)` on every cell for `k` in `[0, n_steps)`.
+  template <class Visitor>
+  void ForEachStep(int n_steps, Visitor&& visitor) const {
+    int n_tiles = tiles_.size();
+    int n_waves = n_tiles + 2 * (n_steps - 1);
+    for (int wave = 0; wave < n_waves; ++wave) {
+      int k_min = std::max(0, (wave - n_tiles + 2) / 2);
+      int k_max = std::min(n_steps - 1, wave / 2);
+      #pragma omp parallel for
+      for (int k = k_min; k <= k_max; ++k) {
+        for (auto* cell : tiles_[wave - 2 * k]) { visitor(*cell, k); }
+      }
+    }
+  }
+
+ private:
+  std::vector<std::vector<CellType*>> tiles_;
+};
+
+}  // namespace solver
+}  // namespace buaa
+
+#endif  // INCLUDE_BUAA_SOLVER_WAVEFRONT_HPP_
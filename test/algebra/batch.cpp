@@ -0,0 +1,68 @@
+// Copyright 2021 Minghao Yang
+#include "buaa/algebra/batch.hpp"
+
+#include <Eigen/Dense>
+#include "gtest/gtest.h"
+
+namespace buaa {
+namespace algebra {
+
+class BatchTest : public ::testing::Test {
+ protected:
+  using Matrix = Eigen::Matrix<float, 9, 9>;
+  using Coefficients = Eigen::Matrix<float, 9, 2>;
+  static Matrix GetSpd(int seed) {
+    std::srand(seed);
+    Matrix a = Matrix::Random();
+    return a * a.transpose() + Matrix::Identity();
+  }
+};
+TEST_F(BatchTest, MultiplyAdd) {
+  Pack<float, 9, 9> a;
+  Pack<float, 9, 2> b, c;
+  c.SetZero();
+  Matrix a_l[kLanes];
+  Coefficients b_l[kLanes];
+  for (int l = 0; l < kLanes; ++l) {
+    a_l[l] = Matrix::Random();
+    b_l[l] = Coefficients::Random();
+    a.Load(l, a_l[l]);
+    b.Load(l, b_l[l]);
+  }
+  MultiplyAdd(a, b, &c);
+  MultiplyAdd(a, b, &c);
+  for (int l = 0; l < kLanes; ++l) {
+    Coefficients c_l;
+    c.Store(l, &c_l);
+    EXPECT_TRUE(c_l.isApprox(a_l[l] * b_l[l] * 2, 1e-5));
+  }
+}
+TEST_F(BatchTest, Invert) {
+  Pack<float, 9, 9> a;
+  Matrix a_l[kLanes];
+  for (int l = 0; l < kLanes; ++l) {
+    a_l[l] = GetSpd(l);
+    a.Load(l, a_l[l]);
+  }
+  Pack<float, 9, 9> inv;
+  Invert<9>(a, &inv);
+  // Leading blocks are inverted on their own:
+  Pack<float, 5, 5> low;
+  Invert<5>(a, &low);
+  for (int l = 0; l < kLanes; ++l) {
+    Matrix inv_l;
+    inv.Store(l, &inv_l);
+    EXPECT_TRUE((inv_l * a_l[l]).isIdentity(1e-3));
+    Eigen::Matrix<float, 5, 5> low_l;
+    low.Store(l, &low_l);
+    EXPECT_TRUE((low_l * a_l[l].topLeftCorner<5, 5>()).isIdentity(1e-3));
+  }
+}
+
+}  // namespace algebra
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -147,6 +147,24 @@ TEST_F(TriangleTest, Factorial) {
   EXPECT_EQ(cell.Factorial(3), 6);
   EXPECT_EQ(cell.Factorial(4), 24);
 }
+TEST_F(TriangleTest, UpdateGeometry) {
+  NodeType d{3, 0.0, 2.0};
+  auto cell = T3(id, a, b, d);
+  d += PointType{0.5, 1.0};
+  cell.UpdateGeometry();
+  auto fresh = T3(id, a, b, d);
+  EXPECT_EQ(cell.Measure(), fresh.Measure());
+  EXPECT_EQ(cell.Center(), fresh.Center());
+  EXPECT_EQ(cell.DxInv(), fresh.DxInv());
+  EXPECT_EQ(cell.XXY(), fresh.XXY());
+  EXPECT_EQ(cell.GetGlobalXY(0.2, 0.2, 0.6), fresh.GetGlobalXY(0.2, 0.2, 0.6));
+  // A translated cell keeps its shape:
+  auto move = PointType{1.0, 2.0};
+  cell.Move(move);
+  EXPECT_EQ(cell.Measure(), fresh.Measure());
+  EXPECT_EQ(cell.XXY(), fresh.XXY());
+  EXPECT_EQ(cell.GetGlobalXY(1.0, 0.0, 0.0), PointType(a + move));
+}
 
 }  // namespace element
 }  // namespace buaa
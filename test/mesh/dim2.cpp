@@ -1,5 +1,6 @@
 // Copyright 2021 Minghao Yang
 
+#include <algorithm>
 #include <vector>
 
 #include "buaa/mesh/dim2.hpp"
@@ -136,6 +137,21 @@ TEST_F(MeshTest, ForEachCell) {
     EXPECT_EQ(cell.Measure(), 0.5);
   });
 }
+TEST_F(MeshTest, ReduceCellsParallel) {
+  for (auto n = 0; n != x.size(); ++n) {
+    mesh.EmplaceNode(n, x[n], y[n]);
+  }
+  mesh.EmplaceCell(0, {0, 1, 2});
+  mesh.EmplaceCell(1, {0, 2, 3});
+  auto min_id = mesh.ReduceCellsParallel(Id(100), [](CellType const& cell) {
+    return cell.I();
+  }, [](Id a, Id b) { return std::min(a, b); });
+  EXPECT_EQ(min_id, 0);
+  auto area = mesh.ReduceCellsParallel(0.0, [](CellType const& cell) {
+    return cell.Measure();
+  }, [](double a, double b) { return a + b; });
+  EXPECT_EQ(area, 1.0);
+}
 TEST_F(MeshTest, GetSide) {
   /*
      3 -- [2] -- 2
@@ -248,6 +264,78 @@ TEST_F(MeshTest, GetMatrix) {
   std::cout << a_mat_inv << std::endl << std::endl;
 }
 
+TEST_F(MeshTest, GetLowDegreeMatrix) {
+  using Mesh3 = Mesh<3, Empty, Empty>;
+  Mesh3 mesh3{};
+  for (auto n = 0; n != x.size(); ++n) {
+    mesh3.EmplaceNode(n, x[n], y[n]);
+  }
+  auto cell = mesh3.EmplaceCell(0, {0, 1, 2});
+  mesh3.EmplaceCell(1, {0, 2, 3});
+  mesh3.ForEachEdge([](Mesh3::Edge& edge) { edge.distance = 0.5; });
+  cell->InitializeAmatInv();
+  EXPECT_EQ(cell->ActiveDegree(), 3);
+  EXPECT_EQ(Mesh3::Cell::CountCoef(1), 2);
+  EXPECT_EQ(Mesh3::Cell::CountCoef(2), 5);
+  // The low-degree inverses invert the leading blocks of the full matrix:
+  Mesh3::Cell::Matrix a_mat = cell->a_matrix_inv.inverse();
+  Eigen::Matrix2f one = cell->GetAmatInv<1>() * a_mat.topLeftCorner<2, 2>();
+  EXPECT_TRUE(one.isIdentity(1e-3));
+  Eigen::Matrix<Scalar, 5, 5> two = cell->GetAmatInv<2>() * a_mat.topLeftCorner<5, 5>();
+  EXPECT_TRUE(two.isIdentity(1e-3));
+  EXPECT_EQ(cell->GetAmatInv<3>(), cell->a_matrix_inv);
+}
+TEST_F(MeshTest, ApplyMatrixFree) {
+  using Mesh3 = Mesh<3, Empty, Empty>;
+  Mesh3 mesh3{};
+  for (auto n = 0; n != x.size(); ++n) {
+    mesh3.EmplaceNode(n, x[n], y[n]);
+  }
+  auto cell_0 = mesh3.EmplaceCell(0, {0, 1, 2});
+  auto cell_1 = mesh3.EmplaceCell(1, {0, 2, 3});
+  auto edge = mesh3.EmplaceEdge(0, 2);
+  edge->distance = (cell_0->Center() - cell_1->Center()).norm();
+  edge->InitializeBmat();
+  auto shift = PointType(0, 0);
+  Eigen::Matrix<Scalar, 9, 2> coefficients = Eigen::Matrix<Scalar, 9, 2>::Random();
+  // `cell_1` has the larger id, so `b_matrix` is oriented for it:
+  Eigen::Matrix<Scalar, 9, 2> value = Eigen::Matrix<Scalar, 9, 2>::Zero();
+  edge->ApplyBmat<9>(*cell_1, shift, coefficients, &value);
+  EXPECT_TRUE(value.isApprox(edge->b_matrix * coefficients, 1e-4));
+  value.setZero();
+  edge->ApplyBmat<9>(*cell_0, shift, coefficients, &value);
+  EXPECT_TRUE(value.isApprox(edge->b_matrix.transpose() * coefficients, 1e-4));
+  // Only the leading rows are formed for lower degrees:
+  Eigen::Matrix<Scalar, 2, 2> low = Eigen::Matrix<Scalar, 2, 2>::Zero();
+  edge->ApplyBmat<2>(*cell_0, shift, coefficients, &low);
+  EXPECT_TRUE(low.isApprox(value.topRows<2>(), 1e-4));
+}
+TEST_F(MeshTest, TranslatedCellsShareAmat) {
+  using Mesh3 = Mesh<3, Empty, Empty>;
+  Mesh3 mesh3{};
+  mesh3.EmplaceNode(0, 0.0, 0.0);
+  mesh3.EmplaceNode(1, 1.0, 0.0);
+  mesh3.EmplaceNode(2, 0.0, 1.0);
+  mesh3.EmplaceNode(3, 2.0, 0.5);
+  mesh3.EmplaceNode(4, 3.0, 0.5);
+  mesh3.EmplaceNode(5, 2.0, 1.5);
+  auto cell_0 = mesh3.EmplaceCell(0, {0, 1, 2});
+  auto cell_1 = mesh3.EmplaceCell(1, {3, 4, 5});
+  mesh3.ForEachEdge([](Mesh3::Edge& edge) { edge.distance = 0.5; });
+  // The basis is centered on each cell, so translates have equal operators:
+  Mesh3::Cell::Matrix a_0, a_1;
+  Mesh3::Cell::LowInv low_0, low_1;
+  cell_0->BuildAmatInv(&a_0, &low_0);
+  cell_1->BuildAmatInv(&a_1, &low_1);
+  EXPECT_TRUE(a_0.isApprox(a_1, 1e-4));
+  EXPECT_TRUE((Mesh3::Cell::GetAmatInv<2>(a_0, low_0)).isApprox(
+              Mesh3::Cell::GetAmatInv<2>(a_1, low_1), 1e-4));
+  Mesh3::Cell::Matrix3V b_0, b_1;
+  cell_0->BuildBvecMat(&b_0);
+  cell_1->BuildBvecMat(&b_1);
+  EXPECT_TRUE(b_0.isApprox(b_1, 1e-4));
+}
+
 }  // namespace mesh
 }  // namespace buaa
 
@@ -13,9 +13,33 @@ class Ausm2dTest : public ::testing::Test {
   using Flux = Solver::FluxType;
   using Vector = Solver::Vector;
   Scalar v__left{1.5}, v_right{2.5};
+  static void CompareFluxes(State const& left, State const& right,
+                            Vector const& normal) {
+    auto rotate = [&](State state) {
+      Solver::GlobalToNormal(state.momentum(), normal);
+      return state;
+    };
+    auto expected = Solver::GetFlux(rotate(left), rotate(right));
+    Solver::NormalToGlobal(expected.momentum(), normal);
+    auto l = IdealGas::PrimitiveToConservative(left);
+    auto r = IdealGas::PrimitiveToConservative(right);
+    Scalar u_l[4] = {l.mass(), l.momentum(0), l.momentum(1), l.energy()};
+    Scalar u_r[4] = {r.mass(), r.momentum(0), r.momentum(1), r.energy()};
+    Scalar f[4];
+    Solver::GetFluxes(1, {&u_l[0], &u_l[1], &u_l[2], &u_l[3]},
+                      {&u_r[0], &u_r[1], &u_r[2], &u_r[3]},
+                      {&normal(0), &normal(1)}, {&f[0], &f[1], &f[2], &f[3]});
+    auto near = [](Scalar actual, Scalar expected) {
+      EXPECT_NEAR(actual, expected, 1e-5 * (1 + std::abs(expected)));
+    };
+    near(f[0], expected.mass());
+    near(f[1], expected.momentum(0));
+    near(f[2], expected.momentum(1));
+    near(f[3], expected.energy());
+  }
   static void CompareFlux(Flux const& lhs, Flux const& rhs) {
-    EXPECT_EQ(lhs.mass, rhs.mass);
-    EXPECT_EQ(lhs.energy, rhs.energy);
+    EXPECT_EQ(lhs.mass(), rhs.mass());
+    EXPECT_EQ(lhs.energy(), rhs.energy());
     EXPECT_EQ(lhs.momentum(0), rhs.momentum(0));
     EXPECT_EQ(lhs.momentum(1), rhs.momentum(1));
   }
@@ -62,12 +86,26 @@ TEST_F(Ausm2dTest, TestVaccumed) {
   CompareFlux(Solver::GetFlux(left, right),
               Solver::GetFlux({0.0, 0.0, v_right, 0.0}));
 }
+TEST_F(Ausm2dTest, TestFluxes) {
+  State states[] = {
+    {1.000, 0.0, v__left, 1.0}, {0.125, 0.0, v_right, 0.1},
+    {5.99924, 19.5975, v__left, 460.894}, {5.99242, 6.19633, v_right, 46.0950},
+    {1.0, 0.0, v__left, 1e+3}, {1.0, 0.0, v_right, 1e-2},
+    {1.0, -2.0, v__left, 0.4}, {1.0, +2.0, v_right, 0.4},
+  };
+  Vector normals[] = {{1.0, 0.0}, {0.0, 1.0}, {0.6, 0.8}, {-0.8, 0.6}};
+  for (auto& normal : normals) {
+    for (auto& left : states) {
+      for (auto& right : states) { CompareFluxes(left, right, normal); }
+    }
+  }
+}
 TEST_F(Ausm2dTest, TestNormal) {
   Vector n(+0.6, 0.8), t(-0.8, 0.6), v(3.0, 4.0), v_copy(3.0, 4.0);
-  Solver::GlobalToNormal(&v, n);
+  Solver::GlobalToNormal(v, n);
   EXPECT_EQ(v(0), v_copy.dot(n));
   EXPECT_EQ(v(1), v_copy.dot(t));
-  Solver::NormalToGlobal(&v, n);
+  Solver::NormalToGlobal(v, n);
   EXPECT_EQ(v(0), v_copy(0));
   EXPECT_EQ(v(1), v_copy(1));
 }
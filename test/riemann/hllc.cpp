@@ -0,0 +1,70 @@
+// Copyright 2021 Minghao Yang
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "buaa/riemann/hllc.hpp"
+
+namespace buaa {
+namespace riemann {
+
+class Hllc2dTest : public ::testing::Test {
+ protected:
+  using Solver = Hllc<IdealGas, 2>;
+  using State = Solver::State;
+  using Flux = Solver::FluxType;
+  static Scalar GetSpeedOfSound(State const& state) {
+    return std::sqrt(IdealGas::Gamma() * state.p() / state.rho());
+  }
+};
+TEST_F(Hllc2dTest, TestContact) {
+  // A stationary contact with shear is kept exactly:
+  State  left{1.000, 0.0, -1.5, 1.0};
+  State right{0.125, 0.0, +2.5, 1.0};
+  auto flux = Solver::GetFlux(left, right);
+  EXPECT_NEAR(flux.mass(), 0.0, 1e-6);
+  EXPECT_NEAR(flux.momentum(0), 1.0, 1e-6);
+  EXPECT_NEAR(flux.momentum(1), 0.0, 1e-6);
+  EXPECT_NEAR(flux.energy(), 0.0, 1e-6);
+}
+TEST_F(Hllc2dTest, TestWaveSpeeds) {
+  Scalar s_l, s_star, s_r;
+  // A moving contact goes at the speed of the flow, between the outer
+  // waves of the faster sound speed:
+  State  left{1.000, 0.3, 0.0, 1.0};
+  State right{0.125, 0.3, 0.0, 1.0};
+  Solver::GetWaveSpeeds(left.rho(), left.u(), left.p(),
+                        right.rho(), right.u(), right.p(), s_l, s_star, s_r);
+  auto a = GetSpeedOfSound(right);
+  EXPECT_NEAR(s_l, 0.3 - a, 1e-6);
+  EXPECT_NEAR(s_star, 0.3, 1e-6);
+  EXPECT_NEAR(s_r, 0.3 + a, 1e-6);
+  // Sod's problem: the contact is between the outer waves, and both star
+  // states have the same pressure:
+  left = State{1.000, 0.0, 0.0, 1.0};
+  right = State{0.125, 0.0, 0.0, 0.1};
+  Solver::GetWaveSpeeds(left.rho(), left.u(), left.p(),
+                        right.rho(), right.u(), right.p(), s_l, s_star, s_r);
+  EXPECT_NEAR(s_l, -GetSpeedOfSound(left), 1e-6);
+  EXPECT_NEAR(s_r, +GetSpeedOfSound(left), 1e-6);
+  EXPECT_LT(0, s_star);
+  EXPECT_LT(s_star, s_r);
+  auto p_star_l = left.p() + left.rho() * (s_l - left.u()) *
+                                          (s_star - left.u());
+  auto p_star_r = right.p() + right.rho() * (s_r - right.u()) *
+                                            (s_star - right.u());
+  EXPECT_NEAR(p_star_l, p_star_r, 1e-6);
+  // The T axis is in the left star region, whose U* the flux jumps to:
+  auto flux = Solver::GetFlux(left, right);
+  auto rho_star = left.rho() * (s_l - left.u()) / (s_l - s_star);
+  EXPECT_NEAR(flux.mass(), s_l * (rho_star - left.rho()), 1e-6);
+  EXPECT_NEAR(flux.momentum(0), rho_star * s_star * s_star + p_star_l, 1e-5);
+}
+
+}  // namespace riemann
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
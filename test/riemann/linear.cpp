@@ -22,6 +22,29 @@ TEST_F(TestLinearWaveTest, TestFlux) {
   a = 0;
   EXPECT_EQ(Solver::GetFlux(u_l, u_r, a), Solver::GetFlux(u_l, a));
 }
+TEST_F(TestLinearWaveTest, TestFluxes) {
+  Scalar u_l[5]{2.0, 2.0, 2.0, -1.0, 3.0}, u_r[5]{1.0, 1.0, 1.0, 4.0, 0.5};
+  Scalar a[5]{1.0, -1.0, 0.0, 0.5, -2.0}, f[5];
+  Solver::GetFluxes(5, {u_l}, {u_r}, {a}, {f});
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(f[i], Solver::GetFlux(u_l[i], u_r[i], a[i]));
+  }
+}
+TEST_F(TestLinearWaveTest, TestMaxSpeed) {
+  Scalar u{2.0};
+  EXPECT_EQ(Solver::GetMaxSpeed(u, 0.5), 0.5);
+  EXPECT_EQ(Solver::GetMaxSpeed(u, -0.5), 0.5);
+}
+TEST_F(TestLinearWaveTest, TestNormal) {
+  Scalar u_l{2.0}, u_r{1.0};
+  for (auto normal : {Solver::Vector(0.6, 0.8), Solver::Vector(-0.6, 0.8),
+                      Solver::Vector(0.0, -1.0)}) {
+    Scalar a = normal(0);
+    EXPECT_EQ(Solver::GetFlux(u_l, u_r, normal), Solver::GetFlux(u_l, u_r, a));
+    EXPECT_EQ(Solver::GetFlux(u_l, normal), Solver::GetFlux(u_l, a));
+    EXPECT_EQ(Solver::GetMaxSpeed(u_l, normal), Solver::GetMaxSpeed(u_l, a));
+  }
+}
 
 }  // namespace riemann
 }  // namespace buaa
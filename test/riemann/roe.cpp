@@ -0,0 +1,79 @@
+// Copyright 2021 Minghao Yang
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "buaa/riemann/roe.hpp"
+
+namespace buaa {
+namespace riemann {
+
+class Roe2dTest : public ::testing::Test {
+ protected:
+  using Solver = Roe<IdealGas, 2>;
+  using State = Solver::State;
+  using Flux = Solver::FluxType;
+  static constexpr Scalar gamma = IdealGas::Gamma();
+  static Scalar GetSpeedOfSound(State const& state) {
+    return std::sqrt(gamma * state.p() / state.rho());
+  }
+  // The isentropic state of speed of sound `a` on the u - a rarefaction
+  // through `state`, along which u + 2a/(gamma - 1) is kept:
+  static State GetRarefied(State const& state, Scalar a) {
+    auto a_0 = GetSpeedOfSound(state);
+    auto rho = state.rho() * std::pow(a / a_0, 2 / (gamma - 1));
+    return {rho, state.u() + 2 * (a_0 - a) / (gamma - 1), state.v(),
+            state.p() * std::pow(rho / state.rho(), gamma)};
+  }
+  static void CompareFlux(Flux const& lhs, Flux const& rhs, Scalar scale) {
+    EXPECT_NEAR(lhs.mass(), rhs.mass(), 1e-5 * scale);
+    EXPECT_NEAR(lhs.momentum(0), rhs.momentum(0), 1e-5 * scale);
+    EXPECT_NEAR(lhs.momentum(1), rhs.momentum(1), 1e-5 * scale);
+    EXPECT_NEAR(lhs.energy(), rhs.energy(), 1e-5 * scale);
+  }
+};
+TEST_F(Roe2dTest, TestEntropyFix) {
+  // A rarefaction whose u - a goes from -0.43 to +0.76, and whose Roe
+  // average is sonic, so that without the fix U_l and U_r would be kept as
+  // a standing expansion shock, of flux F(U_l):
+  State left{1.0, 0.75, 1.5, 1.0};
+  auto right = GetRarefied(left, 0.985);
+  ASSERT_LT(left.u() - GetSpeedOfSound(left), 0);
+  ASSERT_GT(right.u() - GetSpeedOfSound(right), 0);
+  // The exact flux is that of the sonic state inside the fan:
+  auto sonic = GetRarefied(left, 2 / (gamma + 1) *
+      (GetSpeedOfSound(left) + (gamma - 1) / 2 * left.u()));
+  ASSERT_NEAR(sonic.u(), GetSpeedOfSound(sonic), 1e-5);
+  auto exact = Solver::GetFlux(sonic);
+  auto shock = Solver::GetFlux(left);
+  auto flux = Solver::GetFlux(left, right);
+  // The fix moves the flux from the shock's towards the exact one:
+  EXPECT_GT(flux.mass(), shock.mass() + 0.2 * (exact.mass() - shock.mass()));
+  EXPECT_LT(flux.mass(), exact.mass());
+  EXPECT_GT(flux.energy(),
+            shock.energy() + 0.2 * (exact.energy() - shock.energy()));
+  EXPECT_LT(flux.energy(), exact.energy());
+}
+TEST_F(Roe2dTest, TestSingleShock) {
+  // A Mach 2 normal shock, standing in the frame moving at `w`, through
+  // which U_l and U_r meet the Rankine-Hugoniot conditions. The flux is
+  // the upwind one of the shock, which moves at -w:
+  Scalar mach = 2, u_1 = mach * std::sqrt(gamma);
+  Scalar ratio = (gamma + 1) * mach * mach / ((gamma - 1) * mach * mach + 2);
+  Scalar p_2 = 1 + 2 * gamma / (gamma + 1) * (mach * mach - 1);
+  for (Scalar w : {-1.0, +1.0}) {
+    State  left{1.0, u_1 - w, 0.5, 1.0};
+    State right{ratio, u_1 / ratio - w, 0.5, p_2};
+    auto upwind = w < 0 ? left : right;
+    CompareFlux(Solver::GetFlux(left, right), Solver::GetFlux(upwind),
+                1 + p_2);
+  }
+}
+
+}  // namespace riemann
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,7 +1,12 @@
 // Copyright 2019 Weicheng Pei and Minghao Yang
+#include <algorithm>
+#include <type_traits>
+
 #include "gtest/gtest.h"
 
 #include "buaa/riemann/types.hpp"
+#include "buaa/riemann/hllc.hpp"
+#include "buaa/riemann/roe.hpp"
 
 namespace buaa {
 namespace riemann {
@@ -30,6 +35,120 @@ TEST_F(TestIdealGas, TestConverters) {
   EXPECT_FLOAT_EQ(primitive_2.v(), v * 3);
   EXPECT_FLOAT_EQ(primitive_2.p(), p * 3);
 }
+TEST_F(TestIdealGas, TestArithmetic) {
+  auto zero = Conservative<2>(0);
+  EXPECT_EQ(zero, (Conservative<2>{0, 0, 0, 0}));
+  auto u = Conservative<2>{1, 2, 3, 4};
+  auto flux = Flux<2>{0.5, 1, 1.5, 2};
+  // The value takes the type of the left operand:
+  Conservative<2> sum = u + flux * 2;
+  EXPECT_EQ(sum, (Conservative<2>{2, 4, 6, 8}));
+  Conservative<2> difference = 0.5 * u - flux;
+  EXPECT_EQ(difference, zero);
+  EXPECT_EQ(-u / 2, (Conservative<2>{-0.5, -1, -1.5, -2}));
+}
+TEST_F(TestIdealGas, TestConversions) {
+  using Sum = decltype(Primitive<2>() + Primitive<2>());
+  // Expressions are evaluated into any tuple:
+  static_assert(std::is_convertible_v<Sum, Conservative<2>>);
+  static_assert(std::is_assignable_v<Conservative<2>&, Sum>);
+  // Other tuples are only converted explicitly:
+  static_assert(!std::is_convertible_v<Primitive<2>, Conservative<2>>);
+  static_assert(!std::is_convertible_v<Flux<2>, Conservative<2>>);
+  static_assert(!std::is_assignable_v<Conservative<2>&, Primitive<2>>);
+  static_assert(std::is_constructible_v<Conservative<2>, Flux<2>>);
+  EXPECT_EQ(Conservative<2>(Flux<2>{1, 2, 3, 4}),
+            (Conservative<2>{1, 2, 3, 4}));
+}
+
+// The parts `NormalFrame` adds to the two-state flux of a solver:
+class NormalFrameTest : public ::testing::Test {
+ protected:
+  using State = Primitive<2>;
+  using FluxType = Flux<2>;
+  using Vector = State::Vector;
+  // Within a tolerance relative to `scale`, the size of the states, since
+  // their round trip through the conservative form is not exact:
+  static void CompareFlux(FluxType const& lhs, FluxType const& rhs,
+                          Scalar scale = 1) {
+    EXPECT_NEAR(lhs.mass(), rhs.mass(), 1e-5 * scale);
+    EXPECT_NEAR(lhs.momentum(0), rhs.momentum(0), 1e-5 * scale);
+    EXPECT_NEAR(lhs.momentum(1), rhs.momentum(1), 1e-5 * scale);
+    EXPECT_NEAR(lhs.energy(), rhs.energy(), 1e-5 * scale);
+  }
+  static Scalar GetScale(State const& state) {
+    auto conservative = IdealGas::PrimitiveToConservative(state);
+    return std::max({state.p(), conservative.energy(),
+                     conservative.momentum().cwiseAbs().maxCoeff()});
+  }
+  template <class Solver>
+  static FluxType GetFluxes(State const& left, State const& right,
+                        Vector const& normal) {
+    auto l = IdealGas::PrimitiveToConservative(left);
+    auto r = IdealGas::PrimitiveToConservative(right);
+    Scalar u_l[4] = {l.mass(), l.momentum(0), l.momentum(1), l.energy()};
+    Scalar u_r[4] = {r.mass(), r.momentum(0), r.momentum(1), r.energy()};
+    Scalar f[4];
+    Solver::GetFluxes(1, {&u_l[0], &u_l[1], &u_l[2], &u_l[3]},
+                      {&u_r[0], &u_r[1], &u_r[2], &u_r[3]},
+                      {&normal(0), &normal(1)}, {&f[0], &f[1], &f[2], &f[3]});
+    return {f[0], f[1], f[2], f[3]};
+  }
+  template <class Solver>
+  void CheckConsistency() const {
+    for (auto& state : states_) {
+      CompareFlux(Solver::GetFlux(state, state), Solver::GetFlux(state),
+                  1 + GetScale(state));
+    }
+  }
+  template <class Solver>
+  static void CheckSupersonic() {
+    State  left{1.0, +3.0, 1.5, 1.0};
+    State right{0.5, +4.0, 2.5, 0.5};
+    CompareFlux(Solver::GetFlux(left, right), Solver::GetFlux(left));
+    left.momentum(0) = -4.0;
+    right.momentum(0) = -3.0;
+    CompareFlux(Solver::GetFlux(left, right), Solver::GetFlux(right));
+  }
+  template <class Solver>
+  void CheckNormalAndFluxes() const {
+    Vector normals[] = {{1.0, 0.0}, {0.0, 1.0}, {0.6, 0.8}, {-0.8, 0.6}};
+    for (auto& normal : normals) {
+      for (auto& left : states_) {
+        for (auto& right : states_) {
+          auto l = left, r = right;
+          Solver::GlobalToNormal(l.momentum(), normal);
+          Solver::GlobalToNormal(r.momentum(), normal);
+          auto expected = Solver::GetFlux(l, r);
+          Solver::NormalToGlobal(expected.momentum(), normal);
+          Scalar scale = 1 + std::max(GetScale(left), GetScale(right));
+          CompareFlux(Solver::GetFlux(IdealGas::PrimitiveToConservative(left),
+                                      IdealGas::PrimitiveToConservative(right),
+                                      normal), expected, scale);
+          CompareFlux(GetFluxes<Solver>(left, right, normal), expected, scale);
+        }
+      }
+    }
+  }
+  State states_[8] = {
+    {1.000, 0.0, 1.5, 1.0}, {0.125, 0.0, 2.5, 0.1},
+    {5.99924, 19.5975, 1.5, 460.894}, {5.99242, 6.19633, 2.5, 46.0950},
+    {1.0, 0.0, 1.5, 1e+3}, {1.0, 0.0, 2.5, 1e-2},
+    {1.0, -2.0, 1.5, 0.4}, {1.0, +2.0, 2.5, 0.4},
+  };
+};
+TEST_F(NormalFrameTest, TestConsistency) {
+  CheckConsistency<Hllc<IdealGas, 2>>();
+  CheckConsistency<Roe<IdealGas, 2>>();
+}
+TEST_F(NormalFrameTest, TestSupersonic) {
+  CheckSupersonic<Hllc<IdealGas, 2>>();
+  CheckSupersonic<Roe<IdealGas, 2>>();
+}
+TEST_F(NormalFrameTest, TestNormalAndFluxes) {
+  CheckNormalAndFluxes<Hllc<IdealGas, 2>>();
+  CheckNormalAndFluxes<Roe<IdealGas, 2>>();
+}
 
 }  // namespace riemann
 }  // namespace buaa
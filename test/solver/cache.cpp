@@ -0,0 +1,143 @@
+// Copyright 2021 Minghao Yang
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/mesh/dim2.hpp"
+#include "buaa/solver/cache.hpp"
+
+namespace buaa {
+namespace solver {
+
+class VrCacheTest : public ::testing::Test {
+ protected:
+  template <int kDegree>
+  using MeshType = mesh::Mesh<kDegree, mesh::Empty, mesh::Empty>;
+  using Mesh3 = MeshType<3>;
+  using Cell = Mesh3::Cell;
+  using Edge = Mesh3::Edge;
+  const std::string file_name_{"vr_cache_test.bin"};
+  Mesh3 mesh_{};
+  void SetUp() override {
+    std::remove(file_name_.c_str());
+    Build(&mesh_);
+    mesh_.ForEachCell([](Cell& cell) {
+      cell.InitializeAmatInv();
+      cell.b_vector_mat.setRandom();
+    });
+    mesh_.ForEachEdge([](Edge& edge) { edge.b_matrix.setRandom(); });
+  }
+  void TearDown() override {
+    std::remove(file_name_.c_str());
+  }
+  // Two triangles on the unit square:
+  template <class Mesh>
+  static void Build(Mesh* mesh) {
+    mesh->EmplaceNode(0, 0.0, 0.0);
+    mesh->EmplaceNode(1, 1.0, 0.0);
+    mesh->EmplaceNode(2, 1.0, 1.0);
+    mesh->EmplaceNode(3, 0.0, 1.0);
+    mesh->EmplaceCell(0, {0, 1, 2});
+    mesh->EmplaceCell(1, {0, 2, 3});
+    mesh->ForEachEdge([](typename Mesh::Edge& edge) { edge.distance = 0.5; });
+  }
+  // Clear the operators, so that a load has to restore them:
+  void Clear() {
+    mesh_.ForEachCell([](Cell& cell) {
+      cell.a_matrix_inv.setZero();
+      cell.a_matrix_low_inv.fill(0);
+      cell.b_vector_mat.setZero();
+    });
+    mesh_.ForEachEdge([](Edge& edge) { edge.b_matrix.setZero(); });
+  }
+};
+TEST_F(VrCacheTest, SaveAndLoad) {
+  auto cache = VrCache<Mesh3>(file_name_);
+  EXPECT_FALSE(cache.Load(&mesh_));
+  EXPECT_TRUE(cache.Save(mesh_));
+  auto copy = Mesh3();
+  Build(&copy);
+  EXPECT_TRUE(cache.Load(&copy));
+  auto cells = std::vector<Cell*>();
+  copy.ForEachCell([&](Cell& cell) { cells.emplace_back(&cell); });
+  mesh_.ForEachCell([&](Cell& cell) {
+    auto& that = *cells.at(cell.I());
+    EXPECT_EQ(that.a_matrix_inv, cell.a_matrix_inv);
+    EXPECT_EQ(that.a_matrix_low_inv, cell.a_matrix_low_inv);
+    EXPECT_EQ(that.b_vector_mat, cell.b_vector_mat);
+  });
+  auto edges = std::vector<Edge*>();
+  copy.ForEachEdge([&](Edge& edge) { edges.emplace_back(&edge); });
+  int i = 0;
+  mesh_.ForEachEdge([&](Edge& edge) {
+    EXPECT_EQ(edges.at(i++)->b_matrix, edge.b_matrix);
+  });
+}
+TEST_F(VrCacheTest, SaveOverMappedFile) {
+  auto cache = VrCache<Mesh3>(file_name_);
+  EXPECT_TRUE(cache.Save(mesh_));
+  // Map the file as another process still reading it would:
+  int fd = open(file_name_.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  struct stat info;
+  ASSERT_EQ(fstat(fd, &info), 0);
+  void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(addr, MAP_FAILED);
+  auto bytes = static_cast<const char*>(addr);
+  auto old_bytes = std::vector<char>(bytes, bytes + info.st_size);
+  // Save other operators, which replaces the file instead of rewriting it:
+  mesh_.ForEachCell([](Cell& cell) { cell.b_vector_mat.setRandom(); });
+  EXPECT_TRUE(cache.Save(mesh_));
+  EXPECT_EQ(std::memcmp(bytes, old_bytes.data(), old_bytes.size()), 0);
+  munmap(addr, info.st_size);
+  auto temp_name = file_name_ + ".tmp." + std::to_string(getpid());
+  EXPECT_NE(access(temp_name.c_str(), F_OK), 0);
+  // The new file is complete:
+  auto saved = std::vector<Mesh3::Cell::Matrix3V>();
+  mesh_.ForEachCell([&](Cell& cell) { saved.emplace_back(cell.b_vector_mat); });
+  Clear();
+  EXPECT_TRUE(cache.Load(&mesh_));
+  mesh_.ForEachCell([&](Cell& cell) {
+    EXPECT_EQ(cell.b_vector_mat, saved.at(cell.I()));
+  });
+}
+TEST_F(VrCacheTest, RejectMovedNode) {
+  auto cache = VrCache<Mesh3>(file_name_);
+  EXPECT_TRUE(cache.Save(mesh_));
+  mesh_.MoveNode(2, Mesh3::Point(0.1, 0.0));
+  Clear();
+  EXPECT_FALSE(cache.Load(&mesh_));
+  mesh_.ForEachCell([](Cell& cell) {
+    EXPECT_TRUE(cell.a_matrix_inv.isZero());
+  });
+}
+TEST_F(VrCacheTest, RejectOtherPairing) {
+  auto cache = VrCache<Mesh3>(file_name_);
+  EXPECT_TRUE(cache.Save(mesh_));
+  // The distances of edges carry the periodic pairing of cells:
+  mesh_.ForEachEdge([](Edge& edge) { edge.distance = 0.25; });
+  EXPECT_FALSE(cache.Load(&mesh_));
+}
+TEST_F(VrCacheTest, RejectOtherDegree) {
+  EXPECT_TRUE(VrCache<Mesh3>(file_name_).Save(mesh_));
+  auto mesh2 = MeshType<2>();
+  Build(&mesh2);
+  EXPECT_FALSE(VrCache<MeshType<2>>(file_name_).Load(&mesh2));
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+// Copyright 2021 Minghao Yang
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "buaa/solver/lsrk.hpp"
+
+namespace buaa {
+namespace solver {
+
+class LowStorageTest : public ::testing::Test {
+ protected:
+  // Error at t = 1 of u' = -u from u = 1, in `n_steps` steps of `Scheme` run
+  // on two registers as `Rkvr` does:
+  template <class Scheme>
+  static double GetError(int n_steps) {
+    double dt = 1.0 / n_steps, u_0 = 1, u_1 = 0;
+    for (int n = 0; n < n_steps; ++n) {
+      for (auto const& stage : Scheme::Stages()) {
+        double f = -dt * u_0;
+        auto combine = [&](auto const& c) {
+          return u_0 * c[0] + u_1 * c[1] + f * c[2];
+        };
+        double to_0 = combine(stage.to_0);
+        u_1 = combine(stage.to_1);
+        u_0 = to_0;
+      }
+    }
+    return std::abs(u_0 - std::exp(-1.0));
+  }
+  // Order of the error from `n_steps` to twice as many steps, which are few
+  // enough for the error to stay above the rounding of the coefficients:
+  template <class Scheme>
+  static double GetOrder(int n_steps) {
+    return std::log2(GetError<Scheme>(n_steps) /
+                     GetError<Scheme>(n_steps * 2));
+  }
+};
+TEST_F(LowStorageTest, TestOrder) {
+  EXPECT_NEAR(GetOrder<Ssp2<3>>(4), 2, 0.2);
+  EXPECT_NEAR(GetOrder<Ssp2<5>>(4), 2, 0.2);
+  EXPECT_NEAR(GetOrder<Ssp3<2>>(4), 3, 0.2);
+  EXPECT_NEAR(GetOrder<Ssp3<3>>(4), 3, 0.2);
+  EXPECT_NEAR(GetOrder<Ssp104>(2), 4, 0.2);
+  EXPECT_NEAR(GetOrder<Williamson3>(4), 3, 0.2);
+}
+TEST_F(LowStorageTest, TestFirstStage) {
+  // The first stage never reads u_1, which is not set before it:
+  EXPECT_EQ(Ssp2<4>::Stages()[0].to_0[1], 0);
+  EXPECT_EQ(Ssp2<4>::Stages()[0].to_1[1], 0);
+  EXPECT_EQ(Ssp3<3>::Stages()[0].to_0[1], 0);
+  EXPECT_EQ(Ssp3<3>::Stages()[0].to_1[1], 0);
+  EXPECT_EQ(Ssp104::Stages()[0].to_0[1], 0);
+  EXPECT_EQ(Ssp104::Stages()[0].to_1[1], 0);
+  EXPECT_EQ(Williamson3::Stages()[0].to_0[1], 0);
+  EXPECT_EQ(Williamson3::Stages()[0].to_1[1], 0);
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
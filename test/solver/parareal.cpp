@@ -0,0 +1,91 @@
+// Copyright 2021 Minghao Yang
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buaa/solver/parareal.hpp"
+
+namespace buaa {
+namespace solver {
+
+class PararealTest : public ::testing::Test {
+ protected:
+  using Scalar = mesh::Scalar;
+  using Value = std::vector<Scalar>;
+  // u' = -u on slices of `dt_`, whose exact solution is the fine propagator
+  // and forward Euler the coarse one:
+  const int n_slices_{8};
+  const Scalar dt_{0.25};
+  const Value u_0_{1, 2};
+  Parareal<Scalar> parareal_;
+  void Coarse(int n, Value const& u, Value* v) const {
+    v->resize(u.size());
+    for (int i = 0; i < u.size(); ++i) { (*v)[i] = u[i] * (1 - dt_); }
+  }
+  void Fine(int n, Value const& u, Value* v) const {
+    v->resize(u.size());
+    for (int i = 0; i < u.size(); ++i) { (*v)[i] = u[i] * std::exp(-dt_); }
+  }
+  // The fine solution at the end of slice `n - 1`:
+  Scalar GetExact(int n, int i) const {
+    return u_0_[i] * std::exp(-dt_ * n);
+  }
+  template <class Fine>
+  int Solve(Fine&& fine, int max_iterations, Scalar tolerance) {
+    return parareal_.Solve(u_0_, n_slices_, [&](int n, auto& u, auto* v) {
+      Coarse(n, u, v);
+    }, fine, max_iterations, tolerance);
+  }
+  int Solve(int max_iterations, Scalar tolerance) {
+    return Solve([&](int n, auto& u, auto* v) {
+      Fine(n, u, v);
+    }, max_iterations, tolerance);
+  }
+};
+// Stopped after k iterations, before the last slices have converged:
+TEST_F(PararealTest, FirstSlicesExact) {
+  for (int k = 1; k <= 3; ++k) {
+    EXPECT_EQ(Solve(k, 0), k);
+    for (int n = 0; n <= k; ++n) {
+      for (int i = 0; i < u_0_.size(); ++i) {
+        EXPECT_NEAR(parareal_.GetValue(n)[i], GetExact(n, i), 1e-6);
+      }
+    }
+    // The coarse propagator still shows after them:
+    auto error = parareal_.GetValue(n_slices_)[0] - GetExact(n_slices_, 0);
+    EXPECT_GT(std::abs(error), 1e-5);
+  }
+}
+TEST_F(PararealTest, Converge) {
+  int k = Solve(n_slices_, 1e-6);
+  EXPECT_LT(k, n_slices_);
+  EXPECT_EQ(parareal_.GetChanges().size(), k);
+  for (int n = 0; n <= n_slices_; ++n) {
+    for (int i = 0; i < u_0_.size(); ++i) {
+      EXPECT_NEAR(parareal_.GetValue(n)[i], GetExact(n, i), 1e-5);
+    }
+  }
+}
+// A fine propagation that blows up is never taken for convergence:
+TEST_F(PararealTest, NaN) {
+  int k = Solve([&](int n, auto& u, auto* v) {
+    Fine(n, u, v);
+    if (n == 2) { (*v)[1] = std::numeric_limits<Scalar>::quiet_NaN(); }
+  }, 4, 1e-3);
+  EXPECT_EQ(k, 4);
+  for (auto change : parareal_.GetChanges()) {
+    EXPECT_TRUE(std::isnan(change));
+  }
+  EXPECT_TRUE(std::isnan(parareal_.GetValue(n_slices_)[1]));
+  EXPECT_FALSE(std::isnan(parareal_.GetValue(n_slices_)[0]));
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
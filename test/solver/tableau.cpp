@@ -0,0 +1,64 @@
+// Copyright 2021 Minghao Yang
+#include <array>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "buaa/solver/tableau.hpp"
+
+namespace buaa {
+namespace solver {
+
+class TableauTest : public ::testing::Test {
+ protected:
+  // Error at t = 1 of u' = -u from u = 1, in `n_steps` steps of `Scheme` run
+  // on its slots as `Rkvr` does:
+  template <class Scheme>
+  static double GetError(int n_steps) {
+    using Steps = ShuOsherSteps<Scheme>;
+    double dt = 1.0 / n_steps;
+    auto u = std::array<double, Steps::CountSlots()>();
+    u[0] = 1;
+    for (int n = 0; n < n_steps; ++n) {
+      for (int i = 0; i < Steps::kStages; ++i) {
+        double u_i = u[Steps::kSlots[i]];
+        double value = u_i * Steps::Alpha(i, i) - Steps::Beta(i) * dt * u_i;
+        for (int k = 0; k < i; ++k) {
+          value += Steps::Alpha(i, k) * u[Steps::kSlots[k]];
+        }
+        u[Steps::kSlots[i + 1]] = value;
+      }
+    }
+    return std::abs(u[0] - std::exp(-1.0));
+  }
+  // Order of the error from `n_steps` to twice as many steps, which are few
+  // enough for the error to stay above the rounding of the coefficients:
+  template <class Scheme>
+  static double GetOrder(int n_steps) {
+    return std::log2(GetError<Scheme>(n_steps) /
+                     GetError<Scheme>(n_steps * 2));
+  }
+};
+TEST_F(TableauTest, TestOrder) {
+  EXPECT_NEAR(GetOrder<SspRk33>(4), 3, 0.3);
+  EXPECT_NEAR(GetOrder<SspRk54>(2), 4, 0.3);
+  EXPECT_NEAR(GetOrder<SspRk104>(2), 4, 0.3);
+  EXPECT_NEAR(GetOrder<ClassicRk4>(4), 4, 0.3);
+}
+TEST_F(TableauTest, TestReducible) {
+  static_assert(IsReducible(SspRk54::Tableau()));
+  static_assert(IsReducible(ClassicRk4::Tableau()));
+  // L(u^(0)) in the last stage is not of a stage value, as beta[0][0] = 0:
+  auto tableau = ShuOsher<2>();
+  tableau.alpha = {{{1, 0}, {0.5, 0.5}}};
+  tableau.beta = {{{0, 0}, {0.5, 0.5}}};
+  EXPECT_FALSE(IsReducible(tableau));
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+// Copyright 2021 Minghao Yang
+#include <type_traits>
+
+#include "gtest/gtest.h"
+
+#include "buaa/riemann/types.hpp"
+#include "buaa/solver/variables.hpp"
+
+namespace buaa {
+namespace solver {
+
+class VariablesTest : public ::testing::Test {
+ protected:
+  using Scalar = riemann::Scalar;
+  // `FromRow` undoes `ToRow`, and the row lists mass, momentum, energy:
+  template <class State>
+  static void CheckRoundTrip(State const& state) {
+    using Variable = Variables<State>;
+    auto row = Variable::ToRow(state);
+    static_assert(decltype(row)::ColsAtCompileTime == Variable::Count());
+    static_assert(std::is_same_v<decltype(Variable::FromRow(row)), State>);
+    for (int i = 0; i < Variable::Count(); ++i) {
+      EXPECT_EQ(row(i), state(i));
+    }
+    auto back = Variable::FromRow(row);
+    for (int i = 0; i < Variable::Count(); ++i) {
+      EXPECT_EQ(back(i), state(i));
+    }
+  }
+};
+TEST_F(VariablesTest, Scalar) {
+  using Variable = Variables<Scalar>;
+  static_assert(Variable::Count() == 1);
+  Scalar state = -0.375;
+  EXPECT_EQ(Variable::ToRow(state)(0), state);
+  EXPECT_EQ(Variable::FromRow(Variable::ToRow(state)), state);
+}
+TEST_F(VariablesTest, Tuples) {
+  CheckRoundTrip(riemann::Conservative<1>(1.0, 0.5, 2.5));
+  CheckRoundTrip(riemann::Conservative<2>(1.0, 0.5, -0.25, 2.5));
+  CheckRoundTrip(riemann::Conservative<3>(1.0, 0.5, -0.25, 0.125, 2.5));
+  CheckRoundTrip(riemann::Primitive<2>(0.125, -1.5, 3.0, 0.1));
+  CheckRoundTrip(riemann::Flux<2>(0.5, 0.25, 0.0, 1.75));
+}
+// A value of the reconstruction is a mean plus a row of polynomial values:
+TEST_F(VariablesTest, Linear) {
+  using State = riemann::Conservative<2>;
+  using Variable = Variables<State>;
+  State mean(1.0, 0.5, -0.25, 2.5);
+  Variable::Row delta;
+  delta << 0.25, -0.5, 0.75, -1.0;
+  auto value = Variable::FromRow(Variable::ToRow(mean) + delta);
+  EXPECT_EQ(value.mass(), mean.mass() + delta(0));
+  EXPECT_EQ(value.momentum(0), mean.momentum(0) + delta(1));
+  EXPECT_EQ(value.momentum(1), mean.momentum(1) + delta(2));
+  EXPECT_EQ(value.energy(), mean.energy() + delta(3));
+}
+
+}  // namespace solver
+}  // namespace buaa
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}